@@ -0,0 +1,169 @@
+#ifndef CTL_CSR_GRAPH
+#define CTL_CSR_GRAPH
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include "Graph.hpp"
+#include "SearchContext.hpp"
+
+namespace CTL
+{
+	//Compressed sparse row graph: contiguous labels, contiguous edges grouped by source vertex.
+	//Edges of vertex v are [offsets[v], offsets[v+1]).
+	template<typename T>
+	class CSRGraph
+	{
+	public:
+		using Index = std::uint32_t;
+		static constexpr Index None = std::numeric_limits<Index>::max();
+
+	private:
+		std::vector<T> labels;
+		std::vector<Index> offsets;
+		std::vector<Index> targets;
+		std::vector<float> weights;
+
+	public:
+		CSRGraph() = default;
+		CSRGraph(CSRGraph&&) = default;
+		CSRGraph(const CSRGraph&) = default;
+		CSRGraph& operator=(CSRGraph&&) = default;
+		CSRGraph& operator=(const CSRGraph&) = default;
+
+		template<template<typename> class P, template<typename> class Q>
+		explicit CSRGraph(Graph<T, P, Q>& graph)
+		{
+			this->Freeze(graph);
+		}
+
+		//Copies vertices and edges of graph, vertex indices are kept as VertexT::Index()
+		template<template<typename> class P, template<typename> class Q>
+		void Freeze(Graph<T, P, Q>& graph)
+		{
+			const size_t count = graph.VertexCount();
+			size_t edges = 0u;
+			for(auto v : graph)
+			{
+				edges += v->Adjacent().size();
+			}
+			this->labels.clear();
+			this->offsets.clear();
+			this->targets.clear();
+			this->weights.clear();
+			this->labels.reserve(count);
+			this->offsets.reserve(count + 1u);
+			this->targets.reserve(edges);
+			this->weights.reserve(edges);
+			for(auto v : graph)
+			{
+				this->labels.push_back(v->Label());
+				this->offsets.push_back(Index(this->targets.size()));
+				for(auto& partial : v->Adjacent())
+				{
+					this->targets.push_back(Index(partial.getTo()->Index()));
+					this->weights.push_back(float(partial.getWeight()));
+				}
+			}
+			this->offsets.push_back(Index(this->targets.size()));
+		}
+
+		size_t VertexCount() const
+		{
+			return this->labels.size();
+		}
+
+		size_t EdgeCount() const
+		{
+			return this->targets.size();
+		}
+
+		bool Empty() const
+		{
+			return this->labels.empty();
+		}
+
+		const T& Label(Index v) const
+		{
+			return this->labels[v];
+		}
+
+		Index EdgesBegin(Index v) const
+		{
+			return this->offsets[v];
+		}
+
+		Index EdgesEnd(Index v) const
+		{
+			return this->offsets[v + 1u];
+		}
+
+		Index Target(Index e) const
+		{
+			return this->targets[e];
+		}
+
+		float Weight(Index e) const
+		{
+			return this->weights[e];
+		}
+
+		//Resumable A*: AStarBegin, then AStarResume until it stops returning Searching,
+		//then context.Unwind gives the path. Heuristic is called with labels: H(const T& from, const T& to).
+		template<typename Heuristic, template<typename> class Q>
+		void AStarBegin(Index begin, Index end, Heuristic H, SearchContext<Index, Q>& context) const
+		{
+			context.Begin(this->labels.size());
+			context.Relax(begin, None, 0.f);
+			context.open.Push(begin, H(this->labels[begin], this->labels[end]));
+		}
+
+		//Expands at most budget vertices, budget is decreased by vertices expanded
+		template<typename Heuristic, template<typename> class Q>
+		SearchStatus AStarResume(Index end, Heuristic H, SearchContext<Index, Q>& context, size_t& budget) const
+		{
+			auto& queue = context.open;
+			const T& goal = this->labels[end];
+			while(!queue.Empty())
+			{
+				if(queue.Top() == end) return SearchStatus::Found;
+				if(budget == 0u) return SearchStatus::Searching;
+				const Index v = queue.Pop();
+				if(context.State(v) == VertexState::Black) continue;
+				context.Close(v);
+				--budget;
+				const float distance = context.Distance(v);
+				for(Index e = this->offsets[v], last = this->offsets[v + 1u]; e < last; ++e)
+				{
+					const Index u = this->targets[e];
+					if(context.State(u) == VertexState::Black) continue;
+					const float score = distance + this->weights[e];
+					if(score >= context.Distance(u)) continue;
+					context.Relax(u, v, score);
+					queue.Push(u, score + H(this->labels[u], goal));
+				}
+			}
+			return SearchStatus::Failed;
+		}
+
+		//Fills path with vertices from end to begin (begin excluded), returns false when end is unreachable.
+		//All search state lives in context, so the graph may be searched from several threads at once.
+		template<typename Heuristic, template<typename> class Q>
+		bool AStar(Index begin, Index end, Heuristic H, SearchContext<Index, Q>& context, std::vector<Index>& path) const
+		{
+			this->AStarBegin(begin, end, H, context);
+			size_t budget = std::numeric_limits<size_t>::max();
+			if(this->AStarResume(end, H, context, budget) != SearchStatus::Found)
+			{
+				path.clear();
+				return false;
+			}
+			return context.Unwind(begin, end, path);
+		}
+	};
+
+	template<typename T>
+	constexpr typename CSRGraph<T>::Index CSRGraph<T>::None;
+}
+#endif // !CTL_CSR_GRAPH
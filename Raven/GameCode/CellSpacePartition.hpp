@@ -1,18 +1,44 @@
 #pragma once
 #include "Box2D/Common/b2Math.h"
 #include <vector>
-#include <array>
-#include <set>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include "Utilities.hpp"
 #include "QuadObject.hpp"
 #include "Objects.hpp"
 
-namespace
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CELL_SPACE_SSE2
+#endif
+
+//Calls hit(i) for every circle i of count packed circles overlapping circle at pos, four circles at once with SSE2
+template<typename F>
+inline void ForEachOverlap(const float* xs, const float* ys, const float* radii, size_t count, b2Vec2 pos, float radius, F hit)
 {
-	template<typename Vec, typename T>
-	void EraMove(Vec& v, const T& e)
+	size_t i = 0u;
+#ifdef CELL_SPACE_SSE2
+	const __m128 px = _mm_set1_ps(pos.x), py = _mm_set1_ps(pos.y), pr = _mm_set1_ps(radius);
+	for(; i + 4u <= count; i += 4u)
+	{
+		const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), px);
+		const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), py);
+		const __m128 sum = _mm_add_ps(pr, _mm_loadu_ps(radii + i));
+		const __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		const int mask = _mm_movemask_ps(_mm_cmplt_ps(distSq, _mm_mul_ps(sum, sum)));
+		if(!mask) continue;
+		for(size_t lane = 0u; lane < 4u; ++lane)
+		{
+			if(mask & (1 << lane)) hit(i + lane);
+		}
+	}
+#endif
+	for(; i < count; ++i)
 	{
-		v.erase(std::remove(v.begin(), v.end(), e), v.end());
+		const float dx = xs[i] - pos.x, dy = ys[i] - pos.y, sum = radius + radii[i];
+		if(dx * dx + dy * dy < sum * sum) hit(i);
 	}
 }
 
@@ -20,10 +46,20 @@ template<typename T>
 struct Cell
 {
 	std::vector<T*> Entities;
+	//Partition slot of each entity, used to visit entity spanning several cells once per query
+	std::vector<std::uint32_t> Slots;
+	//Packed position and radius of each entity, so distance tests do not touch entities
+	std::vector<float> Xs;
+	std::vector<float> Ys;
+	std::vector<float> Radii;
 	AABB aabb;
 	Cell()
 	{
 		this->Entities.reserve(10u);
+		this->Slots.reserve(10u);
+		this->Xs.reserve(10u);
+		this->Ys.reserve(10u);
+		this->Radii.reserve(10u);
 	}
 	Cell(const Cell&) = default;
 	Cell(Cell&&) = default;
@@ -31,34 +67,176 @@ struct Cell
 	{}
 	explicit Cell(AABB aabb): aabb(aabb)
 	{}
+
+	size_t Find(T* e) const
+	{
+		return size_t(std::find(this->Entities.begin(), this->Entities.end(), e) - this->Entities.begin());
+	}
+
+	void Add(T* e, std::uint32_t slot)
+	{
+		const b2Vec2 pos = e->getPosition();
+		this->Entities.push_back(e);
+		this->Slots.push_back(slot);
+		this->Xs.push_back(pos.x);
+		this->Ys.push_back(pos.y);
+		this->Radii.push_back(e->getShape()->getRadius());
+	}
+
+	//Copies entity position after it moved within cell, false if entity is not here
+	bool Update(T* e)
+	{
+		const size_t i = this->Find(e);
+		if(i == this->Entities.size()) return false;
+		const b2Vec2 pos = e->getPosition();
+		this->Xs[i] = pos.x;
+		this->Ys[i] = pos.y;
+		return true;
+	}
+
+	void Remove(T* e)
+	{
+		const size_t i = this->Find(e);
+		if(i == this->Entities.size()) return;
+		this->Entities.erase(this->Entities.begin() + i);
+		this->Slots.erase(this->Slots.begin() + i);
+		this->Xs.erase(this->Xs.begin() + i);
+		this->Ys.erase(this->Ys.begin() + i);
+		this->Radii.erase(this->Radii.begin() + i);
+	}
+
+	//Moves last entity into the hole, returns slot of removed entity
+	std::uint32_t SwapRemove(T* e)
+	{
+		const size_t i = this->Find(e);
+		if(i == this->Entities.size()) return std::numeric_limits<std::uint32_t>::max();
+		const std::uint32_t slot = this->Slots[i];
+		this->Entities[i] = this->Entities.back();
+		this->Slots[i] = this->Slots.back();
+		this->Xs[i] = this->Xs.back();
+		this->Ys[i] = this->Ys.back();
+		this->Radii[i] = this->Radii.back();
+		this->Entities.pop_back();
+		this->Slots.pop_back();
+		this->Xs.pop_back();
+		this->Ys.pop_back();
+		this->Radii.pop_back();
+		return slot;
+	}
+
+	std::uint32_t Slot(T* e) const
+	{
+		const size_t i = this->Find(e);
+		return i != this->Entities.size() ? this->Slots[i] : std::numeric_limits<std::uint32_t>::max();
+	}
+
+	//Calls visit(i) for every entity i overlapping circle
+	template<typename F>
+	void ForEachOverlapping(b2Vec2 pos, float radius, F visit) const
+	{
+		ForEachOverlap(this->Xs.data(), this->Ys.data(), this->Radii.data(), this->Entities.size(), pos, radius, visit);
+	}
+
+	void Clear()
+	{
+		this->Entities.clear();
+		this->Slots.clear();
+		this->Xs.clear();
+		this->Ys.clear();
+		this->Radii.clear();
+	}
 };
 
-template<typename T, size_t X, size_t Y>
+//How CellSpacePartition stores entities
+enum class PartitionMode
+{
+	//In every cell its AABB overlaps, queries skip entities already visited
+	Overlap,
+	//Only in the cell of its centre, queries are expanded by the largest entity radius.
+	//Move is at most one remove and one push, for entities moving every tick
+	Centre
+};
+
+//Number of CellSpacePartition cells along each axis
+struct PartitionGrid
+{
+	size_t x = 1u;
+	size_t y = 1u;
+
+	//Cells are 4/3 of typical query radius, so query square spans 1.5 cells along each axis and touches 4 to 9 cells.
+	//Cells are never smaller than entities, so entity is in at most 4 cells
+	static PartitionGrid Tuned(float width, float height, float queryRadius, float entityRadius)
+	{
+		const float size = std::max(4.f / 3.f * queryRadius, 2.f * entityRadius);
+		return PartitionGrid{Cells(width, size), Cells(height, size)};
+	}
+
+	static size_t Cells(float extent, float size)
+	{
+		if(!(size > 0.f)) return 1u;
+		return std::max(size_t(1u), size_t(std::round(extent / size)));
+	}
+};
+
+//Where CellSpacePartition keeps its cells
+enum class PartitionStorage
+{
+	//Every cell of width x height grid, positions outside are clamped into border cells
+	Dense,
+	//Only cells ever occupied, in open-addressing hash keyed by cell coordinates. Unbounded
+	Hashed
+};
+
+//Cell coordinates, ordered row by row like partition queries visit them
+struct CellCoord
+{
+	int x = 0;
+	int y = 0;
+
+	bool operator==(const CellCoord& other) const
+	{
+		return this->x == other.x && this->y == other.y;
+	}
+	bool operator!=(const CellCoord& other) const
+	{
+		return !this->operator==(other);
+	}
+	bool operator<(const CellCoord& other) const
+	{
+		return this->y < other.y || (this->y == other.y && this->x < other.x);
+	}
+};
+
+template<typename T>
 class CellSpacePartition
 {
 	class AABBQuery
 	{
-		size_t beginX, beginY, endX, endY;
+		int beginX, beginY, endX, endY;
 	public:
 		explicit AABBQuery(const CellSpacePartition*const space, const AABB& query)
 		{
-			b2Vec2 low = b2Clamp(query.low, b2Vec2_zero, {space->width,space->height});
-			b2Vec2 high = b2Clamp(query.high, b2Vec2_zero, {space->width,space->height});
-			beginX = size_t(X * low.x / space->width);
-			beginX = beginX < X ? beginX : X - 1;
-			beginY = size_t(Y * low.y / space->height);
-			beginY = beginY < Y ? beginY : Y - 1;
-			endX = size_t(X * high.x / space->width);
-			endX = endX < X ? endX : X - 1;
-			endY = size_t(Y * high.y / space->height);
-			endY = endY < Y ? endY : Y - 1;
+			const CellCoord low = space->CellOf(query.low), high = space->CellOf(query.high);
+			beginX = low.x;
+			beginY = low.y;
+			endX = high.x;
+			endY = high.y;
 		}
-		class iterator: std::iterator<std::input_iterator_tag, size_t>
+		//Keeps only cells between low and high, false when none is left
+		bool Clip(CellCoord low, CellCoord high)
+		{
+			beginX = std::max(beginX, low.x);
+			beginY = std::max(beginY, low.y);
+			endX = std::min(endX, high.x);
+			endY = std::min(endY, high.y);
+			return beginX <= endX && beginY <= endY;
+		}
+		class iterator: std::iterator<std::input_iterator_tag, CellCoord>
 		{
 			const AABBQuery* owner;
-			size_t x, y;
+			int x, y;
 		public:
-			iterator(size_t x, size_t y, const AABBQuery* owner): owner(owner), x(x), y(y)
+			iterator(int x, int y, const AABBQuery* owner): owner(owner), x(x), y(y)
 			{}
 			bool operator==(const iterator& other) const
 			{
@@ -81,9 +259,9 @@ class CellSpacePartition
 				}
 				return *this;
 			}
-			size_t operator*() const
+			CellCoord operator*() const
 			{
-				return size_t(x + X*y);
+				return CellCoord{x, y};
 			}
 		};
 		iterator begin()
@@ -92,103 +270,371 @@ class CellSpacePartition
 		}
 		iterator end()
 		{
-			return iterator(beginX, endY + 1u, this);
+			return iterator(beginX, endY + 1, this);
 		}
 	};
-	std::array<Cell<T>, X*Y> cells;
+	using Slot = std::uint32_t;
+	static constexpr Slot NoSlot = std::numeric_limits<Slot>::max();
+	struct Bucket
+	{
+		CellCoord coord;
+		std::uint32_t cell = NoSlot;
+	};
+
+	std::vector<Cell<T>> cells;
+	//Hashed storage, power of two buckets indexing cells, linear probing
+	std::vector<Bucket> table;
+	//Bounds of existing cells
+	CellCoord low, high;
+	//Stamp of the last query that visited entity in the slot
+	std::vector<std::uint32_t> stamps;
+	std::vector<Slot> freeSlots;
+	std::uint32_t stamp = 0u;
+	//Largest radius of entity added in Centre mode
+	float maxRadius = 0.f;
+	const PartitionMode mode;
+	const PartitionStorage storage;
+	const size_t cellsX;
+	const size_t cellsY;
 	const float width;
 	const float height;
 	const float cellWidth;
 	const float cellHeight;
+
+	Slot NewSlot()
+	{
+		if(this->freeSlots.empty())
+		{
+			this->stamps.push_back(0u);
+			return Slot(this->stamps.size() - 1u);
+		}
+		const Slot slot = this->freeSlots.back();
+		this->freeSlots.pop_back();
+		return slot;
+	}
+
+	static size_t Hash(CellCoord c)
+	{
+		std::uint64_t key = std::uint64_t(std::uint32_t(c.x)) << 32u | std::uint32_t(c.y);
+		key *= 0x9E3779B97F4A7C15ull;
+		return size_t(key >> 32u);
+	}
+
+	//Bucket holding c, or empty bucket where it would go
+	size_t Probe(CellCoord c) const
+	{
+		const size_t mask = this->table.size() - 1u;
+		size_t i = Hash(c) & mask;
+		while(this->table[i].cell != NoSlot && this->table[i].coord != c)
+		{
+			i = (i + 1u) & mask;
+		}
+		return i;
+	}
+
+	void Rehash(size_t buckets)
+	{
+		this->table.assign(buckets, Bucket());
+		for(size_t i = 0u; i < this->cells.size(); ++i)
+		{
+			const CellCoord c = this->CellOf(0.5f * (this->cells[i].aabb.low + this->cells[i].aabb.high));
+			this->table[this->Probe(c)] = Bucket{c, std::uint32_t(i)};
+		}
+	}
+
+	Cell<T>* Find(CellCoord c)
+	{
+		if(this->storage == PartitionStorage::Dense)
+			return &this->cells[c.x + this->cellsX * c.y];
+		const Bucket& bucket = this->table[this->Probe(c)];
+		return bucket.cell != NoSlot ? &this->cells[bucket.cell] : nullptr;
+	}
+
+	const Cell<T>* Find(CellCoord c) const
+	{
+		return const_cast<CellSpacePartition*>(this)->Find(c);
+	}
+
+	//Creates hashed cell when needed
+	Cell<T>& Get(CellCoord c)
+	{
+		if(this->storage == PartitionStorage::Dense)
+			return this->cells[c.x + this->cellsX * c.y];
+		Bucket& bucket = this->table[this->Probe(c)];
+		if(bucket.cell != NoSlot)
+			return this->cells[bucket.cell];
+		if(this->cells.empty())
+		{
+			this->low = c;
+			this->high = c;
+		}
+		this->low = CellCoord{std::min(this->low.x, c.x), std::min(this->low.y, c.y)};
+		this->high = CellCoord{std::max(this->high.x, c.x), std::max(this->high.y, c.y)};
+		bucket = Bucket{c, std::uint32_t(this->cells.size())};
+		const b2Vec2 corner{c.x * this->cellWidth, c.y * this->cellHeight};
+		this->cells.emplace_back(corner, corner + b2Vec2{this->cellWidth, this->cellHeight});
+		if(2u * this->cells.size() > this->table.size())
+			this->Rehash(2u * this->table.size());
+		return this->cells.back();
+	}
+
+	//Calls visit with entities of existing cells whose Chebyshev distance from centre is ring
+	template<typename F>
+	void ForEachInRing(CellCoord centre, int ring, F visit) const
+	{
+		for(int y = std::max(centre.y - ring, this->low.y); y <= std::min(centre.y + ring, this->high.y); ++y)
+		{
+			const int step = (y == centre.y - ring || y == centre.y + ring) ? 1 : 2 * ring;
+			for(int x = centre.x - ring; x <= centre.x + ring; x += step)
+			{
+				if(x < this->low.x || x > this->high.x) continue;
+				const Cell<T>* cell = this->Find(CellCoord{x, y});
+				if(!cell) continue;
+				for(T* e : cell->Entities)
+				{
+					visit(e);
+				}
+			}
+		}
+	}
+
+	//Lower bound of distance from pos, which is in centre cell, to cells ring cells away
+	float RingDistance(b2Vec2 pos, CellCoord centre, int ring) const
+	{
+		if(ring == 0) return 0.f;
+		const float left = pos.x - (centre.x - ring + 1) * this->cellWidth;
+		const float right = (centre.x + ring) * this->cellWidth - pos.x;
+		const float bottom = pos.y - (centre.y - ring + 1) * this->cellHeight;
+		const float top = (centre.y + ring) * this->cellHeight - pos.y;
+		return std::max(0.f, std::min(std::min(left, right), std::min(bottom, top)));
+	}
+
+	//Rings needed to cover all existing cells from centre
+	int LastRing(CellCoord centre) const
+	{
+		return std::max(std::max(centre.x - this->low.x, this->high.x - centre.x),
+						std::max(centre.y - this->low.y, this->high.y - centre.y));
+	}
+
+	//False when query holds no existing cell. Hashed storage clips it to bounds of existing cells, so large queries
+	//do not probe every empty cell coordinate
+	bool ClipToCells(AABBQuery& query) const
+	{
+		if(this->storage == PartitionStorage::Dense) return true;
+		return !this->cells.empty() && query.Clip(this->low, this->high);
+	}
+
+	template<typename F>
+	void ForEachCentred(b2Vec2 pos, const float radius, F visit)
+	{
+		const float reach = radius + this->maxRadius;
+		AABB query{pos - b2Vec2{reach, reach}, pos + b2Vec2{reach, reach}};
+		AABBQuery list(this, query);
+		if(!this->ClipToCells(list)) return;
+		for(CellCoord c : list)
+		{
+			const Cell<T>* cell = this->Find(c);
+			if(!cell) continue;
+			cell->ForEachOverlapping(pos, radius, [cell, &visit](size_t i)
+			{
+				visit(cell->Entities[i]);
+			});
+		}
+	}
 public:
-	CellSpacePartition(float width, float height): width(width), height(height), cellWidth(width / X), cellHeight(height / Y)
+	CellSpacePartition(float width, float height, PartitionGrid grid, PartitionMode mode = PartitionMode::Overlap,
+					   PartitionStorage storage = PartitionStorage::Dense)
+		: mode(mode), storage(storage), cellsX(grid.x), cellsY(grid.y), width(width), height(height),
+		cellWidth(width / grid.x), cellHeight(height / grid.y)
 	{
-		for(size_t y = 0u; y < Y; ++y)
+		if(this->storage == PartitionStorage::Hashed)
 		{
-			for(size_t x = 0u; x < X; ++x)
+			this->table.resize(64u);
+			return;
+		}
+		this->cells.resize(grid.x * grid.y);
+		this->low = CellCoord{0, 0};
+		this->high = CellCoord{int(grid.x) - 1, int(grid.y) - 1};
+		for(size_t y = 0u; y < this->cellsY; ++y)
+		{
+			for(size_t x = 0u; x < this->cellsX; ++x)
 			{
 				b2Vec2 low{x * this->cellWidth, y * this->cellHeight};
 				b2Vec2 high{low.x + this->cellWidth, low.y + this->cellHeight};
 				AABB aabb = AABB(low, high);
-				this->cells[x + X*y].aabb = aabb;
+				this->cells[x + this->cellsX * y].aabb = aabb;
 			}
 		}
 	}
 
+	PartitionGrid Grid() const
+	{
+		return PartitionGrid{this->cellsX, this->cellsY};
+	}
+
+	PartitionMode Mode() const
+	{
+		return this->mode;
+	}
+
+	PartitionStorage Storage() const
+	{
+		return this->storage;
+	}
+
+	//Coordinates of cell containing pos. Dense storage clamps them into the grid
+	CellCoord CellOf(b2Vec2 pos) const
+	{
+		constexpr float limit = 1e9f;
+		const float x = std::floor(b2Clamp(pos.x / this->cellWidth, -limit, limit));
+		const float y = std::floor(b2Clamp(pos.y / this->cellHeight, -limit, limit));
+		if(this->storage == PartitionStorage::Hashed)
+			return CellCoord{int(x), int(y)};
+		return CellCoord{int(b2Clamp(x, 0.f, float(this->cellsX - 1u))), int(b2Clamp(y, 0.f, float(this->cellsY - 1u)))};
+	}
+
+	//False when there are no cells yet
+	bool Bounds(CellCoord& low, CellCoord& high) const
+	{
+		if(this->cells.empty()) return false;
+		low = this->low;
+		high = this->high;
+		return true;
+	}
+
 	void ClearCells()
 	{
+		if(this->storage == PartitionStorage::Hashed)
+		{
+			this->cells.clear();
+			this->table.assign(64u, Bucket());
+		}
 		for(Cell<T>& c : cells)
 		{
-			c.Entities.clear();
+			c.Clear();
 		}
+		this->stamps.clear();
+		this->freeSlots.clear();
+		this->maxRadius = 0.f;
 	}
 
-	std::set<T*> CalculateNeighbours(b2Vec2 pos, const float radius)
+	//Calls visit once for every entity overlapping circle, in cell order. Does not allocate
+	template<typename F>
+	void ForEachNeighbour(b2Vec2 pos, const float radius, F visit)
 	{
+		if(this->mode == PartitionMode::Centre)
+		{
+			this->ForEachCentred(pos, radius, visit);
+			return;
+		}
+		if(++this->stamp == 0u)
+		{
+			std::fill(this->stamps.begin(), this->stamps.end(), 0u);
+			this->stamp = 1u;
+		}
 		AABB query{pos - b2Vec2{radius,radius}, pos + b2Vec2{radius, radius}};
-		std::set<T*> setOfNeighbours;
 		AABBQuery list(this, query);
-		float radiusSum = 0.f;
-		for(size_t it : list)
+		if(!this->ClipToCells(list)) return;
+		for(CellCoord c : list)
 		{
-			auto& cell = this->cells[it];
-			if(!cell.Entities.empty() && cell.aabb.isOverlapping(query))
+			const Cell<T>* cell = this->Find(c);
+			if(cell && !cell->Entities.empty() && cell->aabb.isOverlapping(query))
 			{
-				for(T* en : cell.Entities)
+				cell->ForEachOverlapping(pos, radius, [this, cell, &visit](size_t i)
 				{
-					radiusSum = radius + en->getShape()->getRadius();
-					if(b2DistanceSquared(en->getPosition(), pos) < radiusSum*radiusSum)
-					{
-						setOfNeighbours.insert(en);
-					}
-				}
+					std::uint32_t& visited = this->stamps[cell->Slots[i]];
+					if(visited == this->stamp) return;
+					visited = this->stamp;
+					visit(cell->Entities[i]);
+				});
 			}
 		}
-		return setOfNeighbours;
 	}
 
-	size_t PosToIndex(b2Vec2 pos) const
+	//Replaces res with entities overlapping circle, allocates only when res has to grow
+	template<typename U>
+	void CalculateNeighbours(std::vector<U*>& res, b2Vec2 pos, const float radius)
 	{
-		size_t id = size_t(X * pos.x / this->width) + (size_t(Y*pos.y / this->height) * X);
-		return id >= X*Y ? X*Y - 1u : id;
+		res.clear();
+		this->AppendNeighbours(res, pos, radius);
 	}
 
-	void CalculateRockets(std::vector<Rocket*>& res, b2Vec2 pos, float radius)
+	template<typename U>
+	void AppendNeighbours(std::vector<U*>& res, b2Vec2 pos, const float radius)
 	{
-		AABB query{pos - b2Vec2{radius,radius}, pos + b2Vec2{radius, radius}};
-		/*for(Cell<T>& cell : this->cells)
+		this->ForEachNeighbour(pos, radius, [&res](T* en)
 		{
-		if(!cell.Entities.empty() && cell.aabb.isOverlapping(query))
-		{
-		for(T* en : cell.Entities)
-		{
-		if(b2DistanceSquared(en->getPosition(), pos) < radius*radius)
+			res.push_back(en);
+		});
+	}
+
+	//Entity accepted by match with the closest centre to pos, nullptr if there is none. Cells are visited in rings
+	//around pos, search stops once no further ring can hold anything closer. Entities may be up to slack away
+	//from where partition holds them
+	template<typename F>
+	T* Nearest(b2Vec2 pos, F match, float slack = 0.f) const
+	{
+		if(this->cells.empty()) return nullptr;
+		T* best = nullptr;
+		float bestDistance = std::numeric_limits<float>::max();
+		const CellCoord centre = this->CellOf(pos);
+		const int last = this->LastRing(centre);
+		for(int ring = 0; ring <= last; ++ring)
 		{
-		res.push_back(en);
-		}
-		}
+			if(best && std::sqrt(bestDistance) <= this->RingDistance(pos, centre, ring) - slack) break;
+			this->ForEachInRing(centre, ring, [pos, &match, &best, &bestDistance](T* e)
+			{
+				if(e == best || !match(e)) return;
+				const float distance = b2DistanceSquared(pos, e->getPosition());
+				if(distance < bestDistance)
+				{
+					bestDistance = distance;
+					best = e;
+				}
+			});
 		}
-		}*/
-		std::set<Rocket*> setOfNeighbours;
-		AABBQuery list(this, query);
-		float radiusSum = 0.f;
-		for(size_t it : list)
+		return best;
+	}
+
+	//Replaces res with up to k entities accepted by match closest to pos, closest first. Same search as Nearest
+	template<typename U, typename F>
+	void KNearest(std::vector<U*>& res, b2Vec2 pos, size_t k, F match, float slack = 0.f) const
+	{
+		res.clear();
+		if(this->cells.empty() || k == 0u) return;
+		auto distance = [pos](const T* e)
 		{
-			auto& cell = this->cells[it];
-			if(!cell.Entities.empty() && cell.aabb.isOverlapping(query))
+			return b2DistanceSquared(pos, e->getPosition());
+		};
+		const CellCoord centre = this->CellOf(pos);
+		const int last = this->LastRing(centre);
+		for(int ring = 0; ring <= last; ++ring)
+		{
+			if(res.size() == k && std::sqrt(distance(res.back())) <= this->RingDistance(pos, centre, ring) - slack) break;
+			this->ForEachInRing(centre, ring, [&res, k, &match, &distance](T* e)
 			{
-				for(T* en : cell.Entities)
+				const float d = distance(e);
+				if(res.size() == k && d >= distance(res.back())) return;
+				//Entities overlapping several cells are seen more than once
+				if(std::find(res.begin(), res.end(), e) != res.end() || !match(e)) return;
+				auto at = std::find_if(res.begin(), res.end(), [&distance, d](const T* other)
 				{
-					radiusSum = radius + en->getShape()->getRadius();
-					if(b2DistanceSquared(en->getPosition(), pos) < radiusSum*radiusSum)
-					{
-						Rocket* rocket = dynamic_cast<Rocket*>(en);
-						if(rocket) setOfNeighbours.insert(rocket);
-					}
-				}
-			}
+					return d < distance(other);
+				});
+				res.insert(at, e);
+				if(res.size() > k) res.pop_back();
+			});
 		}
-		res.assign(setOfNeighbours.begin(), setOfNeighbours.end());
+	}
+
+	void CalculateRockets(std::vector<Rocket*>& res, b2Vec2 pos, float radius)
+	{
+		res.clear();
+		this->ForEachNeighbour(pos, radius, [&res](T* en)
+		{
+			Rocket* rocket = dynamic_cast<Rocket*>(en);
+			if(rocket) res.push_back(rocket);
+		});
 	}
 
 
@@ -224,15 +670,40 @@ public:
 	void AddEntity(T* e)
 	{
 		if(!e) return;
-		for(size_t index : AABBQuery(this, this->getAABB(e)))
+		const Slot slot = this->NewSlot();
+		if(this->mode == PartitionMode::Centre)
 		{
-			this->cells[index].Entities.push_back(e);
+			this->maxRadius = std::max(this->maxRadius, e->getShape()->getRadius());
+			this->Get(this->CellOf(e->getPosition())).Add(e, slot);
+			return;
+		}
+		for(CellCoord c : AABBQuery(this, this->getAABB(e)))
+		{
+			this->Get(c).Add(e, slot);
 		}
 	}
 
 	void UpdateEntity(T* e, b2Vec2 oldPos)
 	{
+		if(this->mode == PartitionMode::Centre)
+		{
+			const CellCoord from = this->CellOf(oldPos), to = this->CellOf(e->getPosition());
+			Cell<T>* cell = this->Find(from);
+			if(from == to && cell && cell->Update(e)) return;
+			Slot slot = cell ? cell->SwapRemove(e) : NoSlot;
+			//Entity moved earlier without UpdateEntity, it is somewhere else
+			for(size_t i = 0u; slot == NoSlot && i < this->cells.size(); ++i)
+			{
+				slot = this->cells[i].SwapRemove(e);
+			}
+			if(slot != NoSlot)
+				this->Get(to).Add(e, slot);
+			return;
+		}
 		AABBQuery Old(this, getAABB(e, oldPos)), New(this, getAABB(e));
+		const Cell<T>* first = this->Find(*Old.begin());
+		const Slot slot = first ? first->Slot(e) : NoSlot;
+		if(slot == NoSlot) return;
 		auto s1 = Old.begin(), e1 = Old.end(), s2 = New.begin(), e2 = New.end();
 		while(s1 != e1)
 		{
@@ -240,24 +711,25 @@ public:
 			{
 				while(s1 != e1)
 				{
-					EraMove(this->cells[*s1].Entities, e);
+					this->Get(*s1).Remove(e);
 					++s1;
 				}
 				return;
 			}
 			if(*s1 < *s2)
 			{
-				EraMove(this->cells[*s1].Entities, e);
+				this->Get(*s1).Remove(e);
 				++s1;
 			}
 			else
 			{
 				if(*s2 < *s1)
 				{
-					this->cells[*s2].Entities.push_back(e);
+					this->Get(*s2).Add(e, slot);
 				}
 				else
 				{
+					this->Get(*s2).Update(e);
 					++s1;
 				}
 				++s2;
@@ -265,23 +737,67 @@ public:
 		}
 		while(s2 != e2)
 		{
-			this->cells[*s2].Entities.push_back(e);
+			this->Get(*s2).Add(e, slot);
 			++s2;
 		}
 	}
 
-	const std::vector<T*>& getEntities(size_t index) const
+	const std::vector<T*>& getEntities(CellCoord c) const
+	{
+		static const std::vector<T*> none;
+		const Cell<T>* cell = this->Find(c);
+		return cell ? cell->Entities : none;
+	}
+
+	//Replaces res with entities which may overlap cell. Same as getEntities in Overlap mode,
+	//in Centre mode adds entities of neighbouring cells within the largest entity radius plus slack
+	void GatherEntities(std::vector<T*>& res, CellCoord c, float slack = 0.f) const
 	{
-		return this->cells[index].Entities;
+		if(this->mode == PartitionMode::Overlap)
+		{
+			const std::vector<T*>& entities = this->getEntities(c);
+			res.assign(entities.begin(), entities.end());
+			return;
+		}
+		res.clear();
+		const b2Vec2 corner{c.x * this->cellWidth, c.y * this->cellHeight};
+		const b2Vec2 reach{this->maxRadius + slack, this->maxRadius + slack};
+		const AABB aabb(corner - reach, corner + b2Vec2{this->cellWidth, this->cellHeight} + reach);
+		for(CellCoord near : AABBQuery(this, aabb))
+		{
+			const std::vector<T*>& entities = this->getEntities(near);
+			res.insert(res.end(), entities.begin(), entities.end());
+		}
 	}
 
 	void RemoveEntity(T* e)
 	{
 		if(!e) return;
-		for(size_t index : AABBQuery(this, this->getAABB(e)))
+		if(this->mode == PartitionMode::Centre)
 		{
-			auto& ent = this->cells[index].Entities;
-			ent.erase(std::remove(ent.begin(), ent.end(), e), ent.end());
+			Cell<T>* cell = this->Find(this->CellOf(e->getPosition()));
+			Slot slot = cell ? cell->SwapRemove(e) : NoSlot;
+			//Entity moved without UpdateEntity, it is somewhere else
+			for(size_t i = 0u; slot == NoSlot && i < this->cells.size(); ++i)
+			{
+				slot = this->cells[i].SwapRemove(e);
+			}
+			if(slot != NoSlot)
+				this->freeSlots.push_back(slot);
+			return;
+		}
+		AABBQuery list(this, this->getAABB(e));
+		const Cell<T>* first = this->Find(*list.begin());
+		const Slot slot = first ? first->Slot(e) : NoSlot;
+		if(slot == NoSlot) return;
+		for(CellCoord c : list)
+		{
+			Cell<T>* cell = this->Find(c);
+			if(cell) cell->Remove(e);
 		}
+		this->freeSlots.push_back(slot);
 	}
 };
+
+template<typename T>
+constexpr typename CellSpacePartition<T>::Slot CellSpacePartition<T>::NoSlot;
@@ -0,0 +1,141 @@
+#include "EdgeTree.hpp"
+
+constexpr size_t EdgeTree::Width;
+constexpr std::uint32_t EdgeTree::NoChild;
+constexpr size_t EdgeTree::LeafSize;
+constexpr size_t EdgeTree::MaxDepth;
+
+namespace
+{
+	b2Vec2 Centre(const EdgeTree::Entry& entry)
+	{
+		return 0.5f * (entry.edge.From() + entry.edge.To());
+	}
+}
+
+void EdgeTree::Clear()
+{
+	this->entries.clear();
+	this->nodes.clear();
+}
+
+void EdgeTree::Add(SGE::Object* owner, Wall edge)
+{
+	this->entries.push_back(Entry{edge, owner});
+}
+
+void EdgeTree::Remove(SGE::Object* owner)
+{
+	this->entries.erase(std::remove_if(this->entries.begin(), this->entries.end(), [owner](const Entry& entry)
+	{
+		return entry.owner == owner;
+	}), this->entries.end());
+	this->nodes.clear();
+}
+
+void EdgeTree::Build()
+{
+	this->nodes.clear();
+	if(this->entries.empty()) return;
+	this->nodes.reserve(this->entries.size() / 2u + 1u);
+	AABB bounds;
+	this->BuildNode(0u, this->entries.size(), bounds);
+	for(std::vector<float>* packed : {&this->fromXs, &this->fromYs, &this->toXs, &this->toYs})
+	{
+		packed->assign(this->entries.size() + Width - 1u, 0.f);
+	}
+	for(size_t i = 0u; i < this->entries.size(); ++i)
+	{
+		this->fromXs[i] = this->entries[i].edge.From().x;
+		this->fromYs[i] = this->entries[i].edge.From().y;
+		this->toXs[i] = this->entries[i].edge.To().x;
+		this->toYs[i] = this->entries[i].edge.To().y;
+	}
+}
+
+size_t EdgeTree::Size() const
+{
+	return this->entries.size();
+}
+
+const EdgeTree::Entry& EdgeTree::operator[](size_t index) const
+{
+	return this->entries[index];
+}
+
+AABB EdgeTree::Bounds(size_t begin, size_t end) const
+{
+	constexpr float max = std::numeric_limits<float>::max();
+	AABB box(b2Vec2{max, max}, b2Vec2{-max, -max});
+	for(size_t i = begin; i < end; ++i)
+	{
+		for(b2Vec2 p : {this->entries[i].edge.From(), this->entries[i].edge.To()})
+		{
+			box.low = b2Min(box.low, p);
+			box.high = b2Max(box.high, p);
+		}
+	}
+	return box;
+}
+
+std::uint32_t EdgeTree::BuildNode(size_t begin, size_t end, AABB& box)
+{
+	box = this->Bounds(begin, end);
+	const std::uint32_t index = std::uint32_t(this->nodes.size());
+	this->nodes.emplace_back();
+	//Median of edge centres along the longer side of their bounds
+	auto split = [this](size_t from, size_t to)
+	{
+		const size_t mid = from + (to - from) / 2u;
+		if(to - from < 2u) return mid;
+		constexpr float max = std::numeric_limits<float>::max();
+		b2Vec2 low{max, max}, high{-max, -max};
+		for(size_t i = from; i < to; ++i)
+		{
+			low = b2Min(low, Centre(this->entries[i]));
+			high = b2Max(high, Centre(this->entries[i]));
+		}
+		const bool alongX = high.x - low.x >= high.y - low.y;
+		std::nth_element(this->entries.begin() + from, this->entries.begin() + mid, this->entries.begin() + to,
+						 [alongX](const Entry& a, const Entry& b)
+		{
+			return alongX ? Centre(a).x < Centre(b).x : Centre(a).y < Centre(b).y;
+		});
+		return mid;
+	};
+	size_t ranges[Width + 1u];
+	ranges[0] = begin;
+	ranges[2] = split(begin, end);
+	ranges[1] = split(begin, ranges[2]);
+	ranges[3] = split(ranges[2], end);
+	ranges[4] = end;
+
+	Node node;
+	for(size_t i = 0u; i < Width; ++i)
+	{
+		node.lowX[i] = node.lowY[i] = std::numeric_limits<float>::max();
+		node.highX[i] = node.highY[i] = -std::numeric_limits<float>::max();
+		node.child[i] = NoChild;
+		node.count[i] = 0u;
+		const size_t first = ranges[i], last = ranges[i + 1u];
+		if(first == last) continue;
+		AABB child;
+		if(last - first <= LeafSize)
+		{
+			child = this->Bounds(first, last);
+			node.child[i] = std::uint32_t(first);
+			node.count[i] = std::uint32_t(last - first);
+		}
+		else
+		{
+			node.child[i] = this->BuildNode(first, last, child);
+		}
+		node.lowX[i] = child.low.x;
+		node.lowY[i] = child.low.y;
+		node.highX[i] = child.high.x;
+		node.highY[i] = child.high.y;
+	}
+	//Recursion may have moved nodes, so the slot is looked up again
+	this->nodes[index] = node;
+	return index;
+}
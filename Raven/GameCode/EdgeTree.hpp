@@ -0,0 +1,196 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include "Wall.hpp"
+#include "Utilities.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EDGE_TREE_SSE2
+#endif
+
+namespace SGE
+{
+	class Object;
+}
+
+//Bit i is set when segment a-b may cross edge i of four packed edges before segment parameter best.
+//Only a filter with some slack, crossings are confirmed with LineIntersection
+inline int SegmentCrossings(const float* fromX, const float* fromY, const float* toX, const float* toY,
+							b2Vec2 a, b2Vec2 b, float best)
+{
+#ifdef EDGE_TREE_SSE2
+	constexpr float slack = 1e-4f;
+	const __m128 cx = _mm_loadu_ps(fromX), cy = _mm_loadu_ps(fromY);
+	const __m128 cdx = _mm_sub_ps(_mm_loadu_ps(toX), cx), cdy = _mm_sub_ps(_mm_loadu_ps(toY), cy);
+	const __m128 acx = _mm_sub_ps(_mm_set1_ps(a.x), cx), acy = _mm_sub_ps(_mm_set1_ps(a.y), cy);
+	const __m128 abx = _mm_set1_ps(b.x - a.x), aby = _mm_set1_ps(b.y - a.y);
+	const __m128 det = _mm_sub_ps(_mm_mul_ps(abx, cdy), _mm_mul_ps(aby, cdx));
+	//Parallel edges divide by zero, which fails the comparisons below
+	const __m128 s = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(acy, cdx), _mm_mul_ps(acx, cdy)), det);
+	const __m128 t = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(acy, abx), _mm_mul_ps(acx, aby)), det);
+	const __m128 low = _mm_set1_ps(-slack);
+	const __m128 inS = _mm_and_ps(_mm_cmpgt_ps(s, low), _mm_cmplt_ps(s, _mm_set1_ps(best + slack)));
+	const __m128 inT = _mm_and_ps(_mm_cmpgt_ps(t, low), _mm_cmplt_ps(t, _mm_set1_ps(1.f + slack)));
+	return _mm_movemask_ps(_mm_and_ps(inS, inT));
+#else
+	return 0xF;
+#endif
+}
+
+//Bounding volume hierarchy over edges that do not move, quad obstacle sides and level walls.
+//Every node keeps boxes of its four children side by side (x lows, y lows, x highs, y highs), so one visit
+//tests all four with the same arithmetic on consecutive floats. Leaves hold up to four edges, which rays test
+//together from packed endpoint arrays. Build after adding edges, queries do not allocate.
+class EdgeTree
+{
+public:
+	struct Entry
+	{
+		//Obstacle edges have Wall::Invalid type
+		Wall edge;
+		SGE::Object* owner;
+	};
+	static constexpr size_t Width = 4u;
+private:
+	static constexpr std::uint32_t NoChild = std::numeric_limits<std::uint32_t>::max();
+	static constexpr size_t LeafSize = 4u;
+	static constexpr size_t MaxDepth = 64u;
+	struct alignas(16) Node
+	{
+		float lowX[Width], lowY[Width], highX[Width], highY[Width];
+		//Node index when count is 0, otherwise first of count entries. NoChild for unused lanes
+		std::uint32_t child[Width];
+		std::uint32_t count[Width];
+	};
+
+	std::vector<Entry> entries;
+	std::vector<Node> nodes;
+	//Edge endpoints in entry order, padded so four can be loaded from any leaf
+	std::vector<float> fromXs, fromYs, toXs, toYs;
+
+	std::uint32_t BuildNode(size_t begin, size_t end, AABB& box);
+	AABB Bounds(size_t begin, size_t end) const;
+
+	//Calls visit(first, count) for leaves whose box may satisfy hit(lowX, lowY, highX, highY), lanes are tested together
+	template<typename Hit, typename F>
+	void Traverse(Hit hit, F visit) const
+	{
+		if(this->nodes.empty()) return;
+		std::uint32_t stack[MaxDepth];
+		size_t top = 0u;
+		stack[top++] = 0u;
+		while(top > 0u)
+		{
+			const Node& node = this->nodes[stack[--top]];
+			bool lanes[Width];
+			for(size_t i = 0u; i < Width; ++i)
+			{
+				lanes[i] = hit(node.lowX[i], node.lowY[i], node.highX[i], node.highY[i]);
+			}
+			for(size_t i = 0u; i < Width; ++i)
+			{
+				if(!lanes[i] || node.child[i] == NoChild) continue;
+				if(node.count[i] == 0u)
+				{
+					stack[top++] = node.child[i];
+					continue;
+				}
+				visit(node.child[i], node.count[i]);
+			}
+		}
+	}
+public:
+	void Clear();
+	void Add(SGE::Object* owner, Wall edge);
+	//Removes all edges of owner, Build has to be called again
+	void Remove(SGE::Object* owner);
+	void Build();
+
+	size_t Size() const;
+	const Entry& operator[](size_t index) const;
+
+	//Calls visit with every entry whose edge bounds overlap box
+	template<typename F>
+	void ForEachOverlapping(const AABB& box, F visit) const
+	{
+		this->Traverse([&box](float lowX, float lowY, float highX, float highY)
+		{
+			return lowX <= box.high.x && lowY <= box.high.y && highX >= box.low.x && highY >= box.low.y;
+		}, [this, &box, &visit](size_t first, size_t count)
+		{
+			for(size_t e = first; e < first + count; ++e)
+			{
+				const Entry& entry = this->entries[e];
+				const b2Vec2 low = b2Min(entry.edge.From(), entry.edge.To()), high = b2Max(entry.edge.From(), entry.edge.To());
+				if(low.x <= box.high.x && low.y <= box.high.y && high.x >= box.low.x && high.y >= box.low.y)
+					visit(entry);
+			}
+		});
+	}
+
+	//Calls visit with every entry which may be within radius of pos, distance is up to the caller
+	template<typename F>
+	void ForEachNear(b2Vec2 pos, float radius, F visit) const
+	{
+		this->ForEachOverlapping(AABB(pos - b2Vec2{radius, radius}, pos + b2Vec2{radius, radius}), visit);
+	}
+
+	//Closest intersection of segment from-to with accepted edges, distance and point as in LineIntersection
+	template<typename F>
+	bool Raycast(b2Vec2 from, b2Vec2 to, float& distance, b2Vec2& point, const Entry*& hit, F accept) const
+	{
+		const b2Vec2 dir = to - from;
+		const float invX = dir.x != 0.f ? 1.f / dir.x : 0.f;
+		const float invY = dir.y != 0.f ? 1.f / dir.y : 0.f;
+		//Segment parameter of the closest hit so far, boxes entered later are skipped
+		float best = 1.f;
+		hit = nullptr;
+		this->Traverse([&](float lowX, float lowY, float highX, float highY)
+		{
+			float enter = 0.f, exit = best;
+			if(dir.x != 0.f)
+			{
+				const float t0 = (lowX - from.x) * invX, t1 = (highX - from.x) * invX;
+				enter = std::max(enter, std::min(t0, t1));
+				exit = std::min(exit, std::max(t0, t1));
+			}
+			else if(from.x < lowX || from.x > highX) return false;
+			if(dir.y != 0.f)
+			{
+				const float t0 = (lowY - from.y) * invY, t1 = (highY - from.y) * invY;
+				enter = std::max(enter, std::min(t0, t1));
+				exit = std::min(exit, std::max(t0, t1));
+			}
+			else if(from.y < lowY || from.y > highY) return false;
+			return enter <= exit;
+		}, [&](size_t first, size_t count)
+		{
+			const int lanes = SegmentCrossings(&this->fromXs[first], &this->fromYs[first], &this->toXs[first], &this->toYs[first],
+											   from, to, best);
+			for(size_t i = 0u; i < count; ++i)
+			{
+				if(!(lanes & (1 << i))) continue;
+				const Entry& entry = this->entries[first + i];
+				if(!accept(entry)) continue;
+				float ip;
+				b2Vec2 p;
+				if(!LineIntersection(from, to, entry.edge.From(), entry.edge.To(), ip, p)) continue;
+				const float t = b2Dot(p - from, dir) / dir.LengthSquared();
+				if(t >= best && hit) continue;
+				best = t;
+				distance = ip;
+				point = p;
+				hit = &entry;
+			}
+		});
+		return hit != nullptr;
+	}
+
+	bool Raycast(b2Vec2 from, b2Vec2 to, float& distance, b2Vec2& point, const Entry*& hit) const
+	{
+		return this->Raycast(from, to, distance, point, hit, [](const Entry&) { return true; });
+	}
+};
@@ -3,10 +3,12 @@
 
 #include <vector>
 #include <stack>
-#include <queue> ///TODO: Replace
 #include <unordered_map>
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
+#include <ostream>
+#include "Heap.hpp"
 
 namespace CTL
 {
@@ -17,7 +19,7 @@ namespace CTL
 		Black
 	};
 	
-	template<typename,template<typename> class>
+	template<typename,template<typename> class,template<typename> class>
 	class Graph;
 
 	template<typename T>
@@ -80,7 +82,7 @@ namespace CTL
 	template<typename T>
 	class VertexT
 	{
-		template<typename, template<typename> class>
+		template<typename, template<typename> class, template<typename> class>
 		friend class Graph;
 	public:
 		using VertexList = std::vector<PartialEdge<T>>;
@@ -91,6 +93,7 @@ namespace CTL
 		VertexState state = VertexState::White;
 		VertexT* parent = nullptr;
 		VertexList vList = VertexList();
+		size_t index = 0u;
 
 	public:
 		VertexT() : VertexT(T())
@@ -121,6 +124,12 @@ namespace CTL
 			return this->parent;
 		}
 
+		//Position of vertex in its graph, used by flat graph representations
+		size_t Index() const
+		{
+			return this->index;
+		}
+
 		void SetLabel(const T& label)
 		{
 			this->label = label;
@@ -247,7 +256,8 @@ namespace CTL
 		};
 	}
 
-	template<typename T, template <typename> class P = Graphs::Undirected >
+	//Q is the open list of Dijkstra and AStar, keyed by Vertex::Index()
+	template<typename T, template <typename> class P = Graphs::Undirected, template<typename> class Q = QuadHeap>
 	class Graph : public P<T>
 	{
 	public:
@@ -257,11 +267,12 @@ namespace CTL
 		using EdgeList = std::vector<Edge<T>>;
 		using size_type = typename GraphType::size_type;
 		using iterator = typename GraphType::iterator;
-		using QueueEntry = std::pair<Vertex*, double>;
-		using EntryList = std::vector<QueueEntry>;
+		using Queue = Q<double>;
+		using QueueIndex = typename Queue::Index;
 
 	private:
 		GraphType graph;
+		Queue open;
 		long DFSTime = 0;
 		
 		void initialize(Vertex* v)
@@ -273,6 +284,8 @@ namespace CTL
 				u->SetParent(nullptr);
 			}
 			v->SetDistance(0.);
+			this->open.Clear();
+			this->open.Reserve(this->graph.size());
 		}
 		
 		//Adapts Vertex to use as InTree
@@ -334,12 +347,33 @@ namespace CTL
 
 		void AddVertex(Vertex* v)
 		{
+			v->index = this->graph.size();
 			this->graph.push_back(v);
 		}
 		
 		void AddVertex(const T& label)
 		{
-			this->graph.push_back(new Vertex(label));
+			this->AddVertex(new Vertex(label));
+		}
+
+		//Removes v and edges leading to it, edges are found through v adjacency so graph must be undirected.
+		//Caller owns v afterwards.
+		void RemoveVertex(Vertex* v)
+		{
+			for(auto& partial : v->Adjacent())
+			{
+				auto& adjacent = partial.getTo()->Adjacent();
+				adjacent.erase(std::remove_if(adjacent.begin(), adjacent.end(), [v](const PartialEdge<T>& e)
+				{
+					return e.getTo() == v;
+				}), adjacent.end());
+			}
+			v->Adjacent().clear();
+			this->graph.erase(this->graph.begin() + v->index);
+			for(size_t i = v->index; i < this->graph.size(); ++i)
+			{
+				this->graph[i]->index = i;
+			}
 		}
 		
 		Vertex* FindVertex(const T& label)
@@ -379,20 +413,11 @@ namespace CTL
  		{
  			this->initialize(begin);
 			Vertex* u = nullptr, *v = nullptr;
-			//auto cmp = [](const QueueEntry lhs, const QueueEntry rhs)->bool {return lhs.key > rhs.key; };
-			//HeapQueue<QueueEntry, EntryList, decltype(cmp)> queue(cmp);
-			auto comparator = [](const QueueEntry& lhs, const QueueEntry& rhs)->bool
-			{
-				return lhs.second > rhs.second;
-			};
-			std::priority_queue<QueueEntry, std::vector<QueueEntry>, decltype(comparator)> queue(comparator);
-			queue.push(QueueEntry(begin, 0));
- 			while(!queue.empty())
+			this->open.Push(QueueIndex(begin->index), 0.);
+ 			while(!this->open.Empty())
  			{
-				auto ve = queue.top();
-				v = ve.value;
-				queue.pop();
-				if(v->state == VertexState::Black) continue;//Already removed from queue;
+				v = this->graph[this->open.Pop()];
+				if(v->state == VertexState::Black) continue;//Stale entry of lazy queue
 				v->state = VertexState::Black;
 				for (auto partial : v->Adjacent())
 				{
@@ -401,7 +426,7 @@ namespace CTL
 					{
 						u->distance = v->distance + partial.getWeight();
 						u->parent = v;
-						queue.push(QueueEntry(u, u->distance));
+						this->open.Push(QueueIndex(u->index), u->distance);
 					}
 				}
  			}
@@ -409,31 +434,16 @@ namespace CTL
 		
 		void Dijkstra(Vertex* begin,Vertex* end)
 		{
-			for(Vertex* v : this->graph)
-			{
-				v->distance = std::numeric_limits<double>::infinity();
-				v->estimate = std::numeric_limits<double>::infinity();
-				v->parent = nullptr;
-				v->state = VertexState::White;
-			}
-			begin->distance = 0;
+			this->initialize(begin);
 			Vertex* u = nullptr, *v = nullptr;
-			//auto cmp = [](const QueueEntry lhs, const QueueEntry rhs)->bool {return lhs.key > rhs.key; };
-			//HeapQueue<QueueEntry, EntryList, decltype(cmp)> queue(cmp);
-			auto comparator = [](const QueueEntry& lhs, const QueueEntry& rhs)->bool
+			this->open.Push(QueueIndex(begin->index), 0.);
+			while(!this->open.Empty())
 			{
-				return lhs.second > rhs.second;
-			};
-			std::priority_queue<QueueEntry, std::vector<QueueEntry>, decltype(comparator)> queue(comparator);
-			queue.push(QueueEntry(begin, 0));
-			while(!queue.empty())
-			{
-				auto ve = queue.top();
-				v = ve.first;
+				v = this->graph[this->open.Top()];
 				if(v == end) return;
-				queue.pop();
-				if(v->state == VertexState::Black) continue;//Already removed from queue;
-				v->state = VertexState::Black; //Tells that vertex is removed from queuel
+				this->open.Pop();
+				if(v->state == VertexState::Black) continue;//Stale entry of lazy queue
+				v->state = VertexState::Black; //Tells that vertex is removed from queue
 				for(auto partial : v->Adjacent())
 				{
 					u = partial.getTo();
@@ -441,7 +451,7 @@ namespace CTL
 					{
 						u->distance = v->distance + partial.getWeight();
 						u->parent = v;
-						queue.push(QueueEntry(u,u->distance));
+						this->open.Push(QueueIndex(u->index), u->distance);
 					}
 				}
 			}
@@ -457,22 +467,19 @@ namespace CTL
 				v->parent = nullptr;
 				v->state = VertexState::White;
 			}
+			this->open.Clear();
+			this->open.Reserve(this->graph.size());
 			begin->distance = 0;
 			begin->estimate = H(begin, end);
-			auto comparator = [](const QueueEntry& lhs, const QueueEntry& rhs)->bool
-			{
-				return (lhs.second > rhs.second);
-			};
-			std::priority_queue<QueueEntry, std::vector<QueueEntry>, decltype(comparator)> queue(comparator);
-			queue.push(QueueEntry(begin, begin->estimate));
+			this->open.Push(QueueIndex(begin->index), begin->estimate);
 			Vertex *u = nullptr, *v = nullptr;
 			double score = 0;
-			while(!queue.empty())
+			while(!this->open.Empty())
 			{
-				auto ve = queue.top();
-				v = ve.first;
+				v = this->graph[this->open.Top()];
 				if(v == end) return;
-				queue.pop();
+				this->open.Pop();
+				if(v->state == VertexState::Black) continue;//Stale entry of lazy queue
 				v->state = VertexState::Black;
 				for(auto partial : v->Adjacent())
 				{
@@ -482,13 +489,12 @@ namespace CTL
 					if(u->state == VertexState::White)
 					{
 						u->state = VertexState::Gray;
-					//	queue.push(u);
 					}
 					else if(score >= u->distance) continue;
 					u->parent = v;
 					u->distance = score;
 					u->estimate = score + H(u, end);
-					queue.push(QueueEntry(u, u->estimate));
+					this->open.Push(QueueIndex(u->index), u->estimate);
 				}
 			}
 		}
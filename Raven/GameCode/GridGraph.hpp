@@ -1,5 +1,7 @@
 #pragma once
+#include <cmath>
 #include "Graph.hpp"
+#include "CSRGraph.hpp"
 #include "Box2D/Common/b2Math.h"
 
 struct CellLabel
@@ -12,4 +14,31 @@ struct CellLabel
 };
 
 using GridGraph = CTL::Graph<CellLabel>;
-using GridVertex = GridGraph::Vertex;
\ No newline at end of file
+using GridVertex = GridGraph::Vertex;
+using GridCSR = CTL::CSRGraph<CellLabel>;
+using GridSearch = CTL::SearchContext<GridCSR::Index>;
+
+struct GridCell
+{
+	enum State
+	{
+		Valid, Invalid
+	} state = Invalid;
+	GridVertex* vertex = nullptr;
+};
+
+//Octile distance, admissible on 8-connected grid
+class DiagonalDistance
+{
+	constexpr static float sqrt2 = 1.41421356f;
+public:
+	float operator()(const GridVertex* cur, const GridVertex* end) const
+	{
+		return (*this)(cur->Label(), end->Label());
+	}
+	float operator()(const CellLabel& cur, const CellLabel& end) const
+	{
+		float dx = std::abs(cur.position.x - end.position.x), dy = std::abs(cur.position.y - end.position.y);
+		return dx < dy ? dx * sqrt2 + dy - dx : dy * sqrt2 + dx - dy;
+	}
+};
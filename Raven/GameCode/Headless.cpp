@@ -0,0 +1,88 @@
+#include "Headless.hpp"
+
+#include "RavenScene.hpp"
+#include "Logics.hpp"
+#include "SteeringBehavioursUpdate.hpp"
+
+HeadlessRaven::HeadlessRaven(size_t bots, const SimulationClock& clock, unsigned seed, unsigned pathThreads, unsigned simulationThreads,
+							 PartitionStorage storage)
+	: world(Width, Height, partitionQueryRadius, partitionEntityRadius, storage)
+{
+	this->gs = new RavenGameState();
+	this->gs->world = &this->world;
+	this->gs->clock = clock;
+	this->gs->seed = seed;
+	this->gs->pathThreads = pathThreads;
+	this->gs->simulationThreads = simulationThreads;
+
+	//Boundaries, same layout as RavenScene::loadScene
+	SGE::Shape* horizontal = SGE::Shape::Rectangle(Width, 1.f, false);
+	SGE::Shape* vertical = SGE::Shape::Rectangle(1.f, Height + 2.f, false);
+	this->AddWall({-0.5f, Height * 0.5f}, vertical, Wall::Right);
+	this->AddWall({Width + .5f, Height * 0.5f}, vertical, Wall::Left);
+	this->AddWall({Width * 0.5f, Height + .5f}, horizontal, Wall::Bottom);
+	this->AddWall({Width * 0.5f, -0.5f}, horizontal, Wall::Top);
+
+	this->gs->GenerateLevel(bots, RavenBatches{});
+
+	//Logics, in the order RavenScene runs them
+	this->simulation = new SimulationStep(&this->gs->clock);
+	this->simulation->AddLogic(new PartitionSync(&this->world));
+	this->simulation->AddLogic(new NeighbourListUpdate(&this->world, &this->gs->bots));
+	this->simulation->AddLogic(new SteeringBehavioursUpdate(&this->gs->bots, &this->gs->clock));
+	this->simulation->AddLogic(new SeparateBots(&this->world, &this->gs->bots, this->gs->SimulationPool()));
+	this->simulation->AddLogic(new MoveAwayFromObstacle(&this->world, this->gs->obstacles));
+	this->simulation->AddLogic(new MoveAwayFromWall(&this->world, this->gs->bots));
+	this->simulation->AddLogic(new BotLogic(&this->world, this->gs));
+	this->simulation->AddLogic(new ItemLogic(&this->world, this->gs));
+	this->simulation->AddLogic(new RocketLogic(this->gs, &this->world));
+}
+
+HeadlessRaven::~HeadlessRaven()
+{
+	delete this->simulation;
+	for(RavenBot& bot : this->gs->bots)
+		delete bot.RailgunTrace;
+	for(Item* item : this->gs->items)
+		delete item;
+	for(Rocket* rocket : this->gs->rockets)
+		delete rocket;
+	for(Rocket* explosion : this->gs->explosions)
+		delete explosion;
+	for(SGE::Object* ob : this->gs->obstacles)
+		delete ob;
+	delete this->gs;
+	this->world.clear();
+	for(SGE::Object* wall : this->walls)
+		delete wall;
+}
+
+void HeadlessRaven::AddWall(b2Vec2 position, SGE::Shape* shape, Wall::WallEdge edge)
+{
+	SGE::Object* wall = new SGE::Object(position, true, shape);
+	this->world.AddWall(wall, edge);
+	this->walls.push_back(wall);
+}
+
+void HeadlessRaven::Step()
+{
+	this->simulation->Step();
+}
+
+void HeadlessRaven::Run(size_t ticks)
+{
+	for(size_t i = 0u; i < ticks; ++i)
+	{
+		this->Step();
+	}
+}
+
+const SimulationClock& HeadlessRaven::Clock() const
+{
+	return this->gs->clock;
+}
+
+RavenGameState* HeadlessRaven::GameState() const
+{
+	return this->gs;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include "World.hpp"
+#include "SimulationClock.hpp"
+
+namespace SGE
+{
+	class Object;
+}
+class RavenGameState;
+class SimulationStep;
+
+//Runs RavenScene game logic at fixed timestep without Director, window or renderer
+class HeadlessRaven
+{
+protected:
+	World world;
+	RavenGameState* gs = nullptr;
+	std::vector<SGE::Object*> walls;
+	SimulationStep* simulation = nullptr;
+
+	void AddWall(b2Vec2 position, SGE::Shape* shape, Wall::WallEdge edge);
+public:
+	HeadlessRaven(size_t bots, const SimulationClock& clock, unsigned seed, unsigned pathThreads = 0u, unsigned simulationThreads = 0u,
+				  PartitionStorage storage = PartitionStorage::Dense);
+	HeadlessRaven(const HeadlessRaven&) = delete;
+	HeadlessRaven& operator=(const HeadlessRaven&) = delete;
+	~HeadlessRaven();
+
+	void Step();
+	void Run(size_t ticks);
+
+	const SimulationClock& Clock() const;
+	RavenGameState* GameState() const;
+};
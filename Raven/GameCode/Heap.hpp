@@ -0,0 +1,218 @@
+#ifndef CTL_HEAP
+#define CTL_HEAP
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace CTL
+{
+	//Min-heap of vertex indices with decrease-key.
+	//Every index is stored at most once, position table maps index to its slot.
+	template<typename Key, unsigned D = 4u>
+	class IndexedHeap
+	{
+		static_assert(D >= 2u, "Heap arity must be at least 2");
+	public:
+		using Index = std::uint32_t;
+		static constexpr Index None = std::numeric_limits<Index>::max();
+
+	private:
+		struct Entry
+		{
+			Index index;
+			Key key;
+		};
+		std::vector<Entry> heap;
+		std::vector<Index> position;
+
+		void Place(size_t slot, const Entry& entry)
+		{
+			this->heap[slot] = entry;
+			this->position[entry.index] = Index(slot);
+		}
+
+		void SiftUp(size_t slot)
+		{
+			const Entry entry = this->heap[slot];
+			while(slot > 0u)
+			{
+				const size_t parent = (slot - 1u) / D;
+				if(!(entry.key < this->heap[parent].key)) break;
+				this->Place(slot, this->heap[parent]);
+				slot = parent;
+			}
+			this->Place(slot, entry);
+		}
+
+		void SiftDown(size_t slot)
+		{
+			const Entry entry = this->heap[slot];
+			const size_t size = this->heap.size();
+			while(true)
+			{
+				const size_t first = slot * D + 1u;
+				if(first >= size) break;
+				const size_t last = std::min(first + D, size);
+				size_t best = first;
+				for(size_t child = first + 1u; child < last; ++child)
+				{
+					if(this->heap[child].key < this->heap[best].key) best = child;
+				}
+				if(!(this->heap[best].key < entry.key)) break;
+				this->Place(slot, this->heap[best]);
+				slot = best;
+			}
+			this->Place(slot, entry);
+		}
+
+	public:
+		//Makes room for indices [0, count)
+		void Reserve(size_t count)
+		{
+			if(this->position.size() < count)
+			{
+				this->position.resize(count, None);
+			}
+		}
+
+		bool Empty() const
+		{
+			return this->heap.empty();
+		}
+
+		size_t Size() const
+		{
+			return this->heap.size();
+		}
+
+		bool Contains(Index index) const
+		{
+			return index < this->position.size() && this->position[index] != None;
+		}
+
+		//Inserts index or lowers its key, higher key of queued index is ignored
+		void Push(Index index, Key key)
+		{
+			if(index >= this->position.size())
+			{
+				this->position.resize(index + 1u, None);
+			}
+			const Index slot = this->position[index];
+			if(slot == None)
+			{
+				this->heap.push_back(Entry{index, key});
+				this->SiftUp(this->heap.size() - 1u);
+			}
+			else if(key < this->heap[slot].key)
+			{
+				this->heap[slot].key = key;
+				this->SiftUp(slot);
+			}
+		}
+
+		Index Top() const
+		{
+			return this->heap.front().index;
+		}
+
+		Key TopKey() const
+		{
+			return this->heap.front().key;
+		}
+
+		Index Pop()
+		{
+			const Index top = this->heap.front().index;
+			this->position[top] = None;
+			const Entry last = this->heap.back();
+			this->heap.pop_back();
+			if(!this->heap.empty())
+			{
+				this->heap.front() = last;
+				this->SiftDown(0u);
+			}
+			return top;
+		}
+
+		//Costs O(queued), position table is kept
+		void Clear()
+		{
+			for(const Entry& entry : this->heap)
+			{
+				this->position[entry.index] = None;
+			}
+			this->heap.clear();
+		}
+	};
+
+	template<typename Key, unsigned D>
+	constexpr typename IndexedHeap<Key, D>::Index IndexedHeap<Key, D>::None;
+
+	template<typename Key>
+	using QuadHeap = IndexedHeap<Key, 4u>;
+
+	//Binary heap without decrease-key, Push always inserts and stale entries are popped later.
+	//Same interface as IndexedHeap, so callers must skip already closed indices.
+	template<typename Key>
+	class LazyQueue
+	{
+	public:
+		using Index = std::uint32_t;
+
+	private:
+		using Entry = std::pair<Index, Key>;
+		std::vector<Entry> heap;
+
+		static bool Compare(const Entry& lhs, const Entry& rhs)
+		{
+			return lhs.second > rhs.second;
+		}
+
+	public:
+		void Reserve(size_t)
+		{
+		}
+
+		bool Empty() const
+		{
+			return this->heap.empty();
+		}
+
+		size_t Size() const
+		{
+			return this->heap.size();
+		}
+
+		void Push(Index index, Key key)
+		{
+			this->heap.push_back(Entry(index, key));
+			std::push_heap(this->heap.begin(), this->heap.end(), &LazyQueue::Compare);
+		}
+
+		Index Top() const
+		{
+			return this->heap.front().first;
+		}
+
+		Key TopKey() const
+		{
+			return this->heap.front().second;
+		}
+
+		Index Pop()
+		{
+			std::pop_heap(this->heap.begin(), this->heap.end(), &LazyQueue::Compare);
+			const Index top = this->heap.back().first;
+			this->heap.pop_back();
+			return top;
+		}
+
+		void Clear()
+		{
+			this->heap.clear();
+		}
+	};
+}
+#endif // !CTL_HEAP
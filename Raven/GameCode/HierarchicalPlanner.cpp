@@ -0,0 +1,270 @@
+#include "HierarchicalPlanner.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+size_t HierarchicalPlanner::ClusterOf(b2Vec2 position) const
+{
+	const size_t x = size_t(std::floor(position.x)), y = size_t(std::floor(position.y));
+	return (y / this->clusterSize) * this->clustersX + x / this->clusterSize;
+}
+
+HierarchicalPlanner::AbstractVertex* HierarchicalPlanner::Entrance(Index vertex)
+{
+	AbstractVertex*& entrance = this->entrances[vertex];
+	if(!entrance)
+	{
+		const size_t cluster = this->clusters[vertex];
+		entrance = new AbstractVertex(EntranceLabel(vertex, this->navgraph->Label(vertex).position, cluster));
+		this->abstract.AddVertex(entrance);
+		this->clusterEntrances[cluster].push_back(entrance);
+	}
+	return entrance;
+}
+
+void HierarchicalPlanner::AddBorder(const std::vector<std::pair<Index, Index>>& border)
+{
+	//Short runs of connected cells get one entrance in the middle, long ones one at each end
+	const size_t count = border.size();
+	size_t first = 0u;
+	while(first < count)
+	{
+		if(border[first].first == GridCSR::None)
+		{
+			++first;
+			continue;
+		}
+		size_t last = first;
+		while(last < count && border[last].first != GridCSR::None)
+			++last;
+		const size_t length = last - first;
+		std::vector<size_t> picks;
+		if(length < 6u)
+			picks.push_back(first + length / 2u);
+		else
+			picks = {first, last - 1u};
+		for(size_t pick : picks)
+		{
+			this->abstract.AddEdge(this->Entrance(border[pick].first), this->Entrance(border[pick].second), 1.);
+		}
+		first = last;
+	}
+}
+
+void HierarchicalPlanner::Explore(Index begin, Index end, GridSearch& context) const
+{
+	const GridCSR& graph = *this->navgraph;
+	const size_t cluster = this->clusters[begin];
+	DiagonalDistance H;
+	auto estimate = [&](Index v)
+	{
+		return end != GridCSR::None ? H(graph.Label(v), graph.Label(end)) : 0.f;
+	};
+	context.Begin(graph.VertexCount());
+	auto& queue = context.open;
+	context.Relax(begin, GridCSR::None, 0.f);
+	queue.Push(begin, estimate(begin));
+	while(!queue.Empty())
+	{
+		const Index v = queue.Pop();
+		if(v == end) break;
+		if(context.State(v) == CTL::VertexState::Black) continue;
+		context.Close(v);
+		const float distance = context.Distance(v);
+		for(Index e = graph.EdgesBegin(v), last = graph.EdgesEnd(v); e < last; ++e)
+		{
+			const Index u = graph.Target(e);
+			if(this->clusters[u] != cluster || context.State(u) == CTL::VertexState::Black) continue;
+			const float score = distance + graph.Weight(e);
+			if(score >= context.Distance(u)) continue;
+			context.Relax(u, v, score);
+			queue.Push(u, score + estimate(u));
+		}
+	}
+}
+
+void HierarchicalPlanner::Connect(AbstractVertex* vertex, GridSearch& context, bool entrance)
+{
+	const EntranceLabel& label = vertex->Label();
+	this->Explore(label.vertex, GridCSR::None, context);
+	for(AbstractVertex* other : this->clusterEntrances[label.cluster])
+	{
+		//Entrances connect to ones added before them, so each pair gets one edge
+		if(entrance && other == vertex) break;
+		if(other == vertex) continue;
+		const float distance = context.Distance(other->Label().vertex);
+		if(distance < std::numeric_limits<float>::infinity())
+			this->abstract.AddEdge(vertex, other, distance);
+	}
+}
+
+void HierarchicalPlanner::Build(const GridCSR& navgraph, size_t width, size_t height, size_t clusterSize)
+{
+	this->navgraph = &navgraph;
+	this->clusterSize = clusterSize;
+	this->clustersX = (width + clusterSize - 1u) / clusterSize;
+	const size_t clustersY = (height + clusterSize - 1u) / clusterSize;
+	const size_t count = navgraph.VertexCount();
+	this->clusters.resize(count);
+	this->entrances.assign(count, nullptr);
+	this->clusterEntrances.assign(this->clustersX * clustersY, {});
+
+	std::vector<Index> grid(width * height, GridCSR::None);
+	for(Index v = 0u; v < count; ++v)
+	{
+		const b2Vec2 position = navgraph.Label(v).position;
+		this->clusters[v] = this->ClusterOf(position);
+		grid[size_t(std::floor(position.y)) * width + size_t(std::floor(position.x))] = v;
+	}
+	//Pair of cells across border, None when they are not joined by navgraph edge
+	auto crossing = [&navgraph, &grid, width](size_t x0, size_t y0, size_t x1, size_t y1)
+	{
+		const Index a = grid[y0 * width + x0], b = grid[y1 * width + x1];
+		if(a != GridCSR::None && b != GridCSR::None)
+		{
+			for(Index e = navgraph.EdgesBegin(a), last = navgraph.EdgesEnd(a); e < last; ++e)
+			{
+				if(navgraph.Target(e) == b) return std::make_pair(a, b);
+			}
+		}
+		return std::make_pair(GridCSR::None, GridCSR::None);
+	};
+	std::vector<std::pair<Index, Index>> border;
+	for(size_t x = clusterSize; x < width; x += clusterSize)
+	{
+		for(size_t y0 = 0u; y0 < height; y0 += clusterSize)
+		{
+			border.clear();
+			for(size_t y = y0; y < std::min(y0 + clusterSize, height); ++y)
+				border.push_back(crossing(x - 1u, y, x, y));
+			this->AddBorder(border);
+		}
+	}
+	for(size_t y = clusterSize; y < height; y += clusterSize)
+	{
+		for(size_t x0 = 0u; x0 < width; x0 += clusterSize)
+		{
+			border.clear();
+			for(size_t x = x0; x < std::min(x0 + clusterSize, width); ++x)
+				border.push_back(crossing(x, y - 1u, x, y));
+			this->AddBorder(border);
+		}
+	}
+
+	GridSearch context;
+	for(auto& cluster : this->clusterEntrances)
+	{
+		for(AbstractVertex* entrance : cluster)
+		{
+			this->Connect(entrance, context, true);
+		}
+	}
+}
+
+bool HierarchicalPlanner::SearchCluster(Index begin, Index end, GridSearch& context, std::vector<Index>& path) const
+{
+	if(this->clusters[begin] != this->clusters[end])
+	{
+		path.clear();
+		return false;
+	}
+	this->Explore(begin, end, context);
+	return context.Unwind(begin, end, path);
+}
+
+bool HierarchicalPlanner::Refine(Index from, Index to, std::vector<b2Vec2>& segment) const
+{
+	thread_local GridSearch context;
+	thread_local std::vector<Index> indices;
+	segment.clear();
+	if(this->clusters[from] != this->clusters[to])
+	{
+		//Abstract edges between clusters join neighbouring cells
+		segment.push_back(this->navgraph->Label(to).position);
+		return true;
+	}
+	if(!this->SearchCluster(from, to, context, indices)) return false;
+	segment.reserve(indices.size());
+	for(Index v : indices)
+	{
+		segment.push_back(this->navgraph->Label(v).position);
+	}
+	return true;
+}
+
+Path HierarchicalPlanner::FindPath(Index begin, Index end, GridSearch& context)
+{
+	std::vector<Index> corridor;
+	if(this->SearchCluster(begin, end, context, corridor))
+	{
+		std::vector<b2Vec2> waypoints;
+		waypoints.reserve(corridor.size());
+		for(Index v : corridor)
+		{
+			waypoints.push_back(this->navgraph->Label(v).position);
+		}
+		return Path(std::move(waypoints));
+	}
+
+	//Query ends which are not entrances are linked into abstract graph for this search only
+	AbstractVertex* start = this->entrances[begin];
+	AbstractVertex* goal = this->entrances[end];
+	const bool temporaryStart = !start, temporaryGoal = !goal;
+	if(temporaryStart)
+	{
+		start = new AbstractVertex(EntranceLabel(begin, this->navgraph->Label(begin).position, this->clusters[begin]));
+		this->abstract.AddVertex(start);
+		this->Connect(start, context, false);
+	}
+	if(temporaryGoal)
+	{
+		goal = new AbstractVertex(EntranceLabel(end, this->navgraph->Label(end).position, this->clusters[end]));
+		this->abstract.AddVertex(goal);
+		this->Connect(goal, context, false);
+	}
+	this->abstract.AStar(start, goal, [](const AbstractVertex* a, const AbstractVertex* b)
+	{
+		return DiagonalDistance()(CellLabel(a->Label().position), CellLabel(b->Label().position));
+	});
+	corridor.clear();
+	if(goal->Distance() < std::numeric_limits<double>::infinity())
+	{
+		for(AbstractVertex* v = goal; v != start; v = v->Parent())
+		{
+			corridor.push_back(v->Label().vertex);
+		}
+		corridor.push_back(begin);
+	}
+	if(temporaryGoal)
+	{
+		this->abstract.RemoveVertex(goal);
+		delete goal;
+	}
+	if(temporaryStart)
+	{
+		this->abstract.RemoveVertex(start);
+		delete start;
+	}
+	if(corridor.empty()) return Path();
+
+	//Corridor runs from end to begin, its back is the vertex reached so far
+	const HierarchicalPlanner* planner = this;
+	return Path([planner, corridor](std::vector<b2Vec2>& segment) mutable -> bool
+	{
+		if(corridor.size() < 2u) return false;
+		const Index from = corridor.back();
+		corridor.pop_back();
+		return planner->Refine(from, corridor.back(), segment);
+	}, this->navgraph->Label(end).position);
+}
+
+size_t HierarchicalPlanner::EntranceCount() const
+{
+	size_t count = 0u;
+	for(auto& cluster : this->clusterEntrances)
+	{
+		count += cluster.size();
+	}
+	return count;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "GridGraph.hpp"
+#include "Path.hpp"
+
+//Vertex of abstract graph: navgraph vertex lying on cluster border, or temporary query end
+struct EntranceLabel
+{
+	GridCSR::Index vertex = GridCSR::None;
+	b2Vec2 position = b2Vec2_zero;
+	size_t cluster = 0u;
+	EntranceLabel() = default;
+	EntranceLabel(GridCSR::Index vertex, b2Vec2 position, size_t cluster): vertex(vertex), position(position), cluster(cluster)
+	{}
+};
+
+//HPA*: navgraph is split into square clusters, entrances between neighbouring clusters and
+//intra-cluster costs form abstract graph. Queries search the abstract graph, then returned Path
+//is refined into navgraph waypoints one abstract edge at a time as it is followed.
+class HierarchicalPlanner
+{
+public:
+	using Index = GridCSR::Index;
+	using AbstractGraph = CTL::Graph<EntranceLabel>;
+	using AbstractVertex = AbstractGraph::Vertex;
+
+private:
+	const GridCSR* navgraph = nullptr;
+	size_t clusterSize = 10u, clustersX = 0u;
+	std::vector<size_t> clusters;
+	std::vector<AbstractVertex*> entrances;
+	std::vector<std::vector<AbstractVertex*>> clusterEntrances;
+	AbstractGraph abstract;
+
+	size_t ClusterOf(b2Vec2 position) const;
+	AbstractVertex* Entrance(Index vertex);
+	void AddBorder(const std::vector<std::pair<Index, Index>>& border);
+	//Search limited to cluster of begin, end == None explores whole cluster
+	void Explore(Index begin, Index end, GridSearch& context) const;
+	void Connect(AbstractVertex* vertex, GridSearch& context, bool entrance);
+
+public:
+	HierarchicalPlanner() = default;
+	HierarchicalPlanner(const HierarchicalPlanner&) = delete;
+	HierarchicalPlanner& operator=(const HierarchicalPlanner&) = delete;
+
+	//Called once per level, navgraph must outlive planner and paths it returned
+	void Build(const GridCSR& navgraph, size_t width, size_t height, size_t clusterSize = 10u);
+
+	//A* inside one cluster, fills path like CSRGraph::AStar
+	bool SearchCluster(Index begin, Index end, GridSearch& context, std::vector<Index>& path) const;
+	//Navgraph waypoints between consecutive abstract path vertices, ordered like Path waypoints
+	bool Refine(Index from, Index to, std::vector<b2Vec2>& segment) const;
+	//Empty Path when end is unreachable through the abstract graph
+	Path FindPath(Index begin, Index end, GridSearch& context);
+
+	size_t EntranceCount() const;
+};
@@ -0,0 +1,272 @@
+#include "JumpPointSearch.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+
+constexpr JumpPointSearch::Index JumpPointSearch::None;
+
+namespace
+{
+	int Sign(int value)
+	{
+		return (value > 0) - (value < 0);
+	}
+
+	//Bit of move (dx, dy) in neighbour mask
+	std::uint16_t MoveBit(int dx, int dy)
+	{
+		return std::uint16_t(1u << ((dy + 1) * 3 + dx + 1));
+	}
+
+	//Octile distance between cells
+	float GridDistance(int dx, int dy)
+	{
+		constexpr float sqrt2 = 1.41421356f;
+		dx = std::abs(dx);
+		dy = std::abs(dy);
+		return dx < dy ? dx * sqrt2 + dy - dx : dy * sqrt2 + dx - dy;
+	}
+}
+
+void JumpPointSearch::Build(const GridCell* cells, size_t width, size_t height)
+{
+	this->width = int(width);
+	this->height = int(height);
+	const size_t count = width * height;
+	this->walkable.assign(count, 0u);
+	std::vector<std::uint16_t> moves(count, 0u);
+	for(size_t i = 0u; i < count; ++i)
+	{
+		GridVertex* vertex = cells[i].vertex;
+		if(cells[i].state != GridCell::Valid || !vertex) continue;
+		this->walkable[i] = 1u;
+		const b2Vec2 position = vertex->Label().position;
+		for(auto& partial : vertex->Adjacent())
+		{
+			const b2Vec2 d = partial.getTo()->Label().position - position;
+			moves[i] |= MoveBit(int(std::round(d.x)), int(std::round(d.y)));
+		}
+	}
+
+	std::vector<Index> excluded;
+	for(int y = 0; y < this->height; ++y)
+	{
+		for(int x = 0; x < this->width; ++x)
+		{
+			const Index cell = this->Cell(x, y);
+			if(!this->walkable[cell]) continue;
+			for(int dy = -1; dy <= 1; ++dy)
+			{
+				for(int dx = -1; dx <= 1; ++dx)
+				{
+					if(!(dx || dy) || !this->Walkable(x + dx, y + dy)) continue;
+					if(dx && dy && !(this->Walkable(x + dx, y) && this->Walkable(x, y + dy))) continue;
+					if(moves[cell] & MoveBit(dx, dy)) continue;
+					excluded.push_back(cell);
+					excluded.push_back(this->Cell(x + dx, y + dy));
+				}
+			}
+		}
+	}
+	for(Index cell : excluded)
+	{
+		this->walkable[cell] = 0u;
+	}
+}
+
+bool JumpPointSearch::Walkable(Index cell) const
+{
+	return cell < this->walkable.size() && this->walkable[cell];
+}
+
+JumpPointSearch::Index JumpPointSearch::CellIndex(b2Vec2 position) const
+{
+	const int x = int(std::floor(position.x)), y = int(std::floor(position.y));
+	if(x < 0 || y < 0 || x >= this->width || y >= this->height) return None;
+	return this->Cell(x, y);
+}
+
+b2Vec2 JumpPointSearch::CellCentre(Index cell) const
+{
+	return b2Vec2{0.5f + float(cell % this->width), 0.5f + float(cell / this->width)};
+}
+
+JumpPointSearch::Index JumpPointSearch::JumpStraight(int x, int y, int dx, int dy, Index goal) const
+{
+	while(this->Walkable(x, y))
+	{
+		const Index cell = this->Cell(x, y);
+		if(cell == goal) return cell;
+		if(dx)
+		{
+			if((this->Walkable(x, y - 1) && !this->Walkable(x - dx, y - 1)) ||
+			   (this->Walkable(x, y + 1) && !this->Walkable(x - dx, y + 1)))
+				return cell;
+		}
+		else
+		{
+			if((this->Walkable(x - 1, y) && !this->Walkable(x - 1, y - dy)) ||
+			   (this->Walkable(x + 1, y) && !this->Walkable(x + 1, y - dy)))
+				return cell;
+		}
+		x += dx;
+		y += dy;
+	}
+	return None;
+}
+
+JumpPointSearch::Index JumpPointSearch::Jump(int x, int y, int dx, int dy, Index goal) const
+{
+	if(!(dx && dy)) return this->JumpStraight(x, y, dx, dy, goal);
+	while(this->Walkable(x, y))
+	{
+		const Index cell = this->Cell(x, y);
+		if(cell == goal) return cell;
+		if(this->JumpStraight(x + dx, y, dx, 0, goal) != None || this->JumpStraight(x, y + dy, 0, dy, goal) != None)
+			return cell;
+		if(!(this->Walkable(x + dx, y) && this->Walkable(x, y + dy))) return None;
+		x += dx;
+		y += dy;
+	}
+	return None;
+}
+
+size_t JumpPointSearch::Directions(int x, int y, Index parent, int (&directions)[8][2]) const
+{
+	size_t count = 0u;
+	auto add = [&directions, &count](int dx, int dy)
+	{
+		directions[count][0] = dx;
+		directions[count][1] = dy;
+		++count;
+	};
+	if(parent == None)
+	{
+		for(int dy = -1; dy <= 1; ++dy)
+			for(int dx = -1; dx <= 1; ++dx)
+			{
+				if(!(dx || dy)) continue;
+				if(dx && dy && !(this->Walkable(x + dx, y) && this->Walkable(x, y + dy))) continue;
+				add(dx, dy);
+			}
+		return count;
+	}
+	const int dx = Sign(x - int(parent % this->width)), dy = Sign(y - int(parent / this->width));
+	if(dx && dy)
+	{
+		const bool horizontal = this->Walkable(x + dx, y), vertical = this->Walkable(x, y + dy);
+		if(vertical) add(0, dy);
+		if(horizontal) add(dx, 0);
+		if(horizontal && vertical) add(dx, dy);
+	}
+	else if(dx)
+	{
+		const bool next = this->Walkable(x + dx, y), up = this->Walkable(x, y + 1), down = this->Walkable(x, y - 1);
+		if(next)
+		{
+			add(dx, 0);
+			if(up) add(dx, 1);
+			if(down) add(dx, -1);
+		}
+		if(up) add(0, 1);
+		if(down) add(0, -1);
+	}
+	else
+	{
+		const bool next = this->Walkable(x, y + dy), right = this->Walkable(x + 1, y), left = this->Walkable(x - 1, y);
+		if(next)
+		{
+			add(0, dy);
+			if(right) add(1, dy);
+			if(left) add(-1, dy);
+		}
+		if(right) add(1, 0);
+		if(left) add(-1, 0);
+	}
+	return count;
+}
+
+bool JumpPointSearch::SearchBegin(Index begin, Index end, GridSearch& context) const
+{
+	if(!this->Walkable(begin) || !this->Walkable(end)) return false;
+	context.Begin(this->walkable.size());
+	const int gx = int(end % this->width), gy = int(end / this->width);
+	context.Relax(begin, None, 0.f);
+	context.open.Push(begin, GridDistance(int(begin % this->width) - gx, int(begin / this->width) - gy));
+	return true;
+}
+
+CTL::SearchStatus JumpPointSearch::SearchResume(Index end, GridSearch& context, size_t& budget) const
+{
+	auto& queue = context.open;
+	const int gx = int(end % this->width), gy = int(end / this->width);
+	int directions[8][2];
+	while(!queue.Empty())
+	{
+		if(queue.Top() == end) return CTL::SearchStatus::Found;
+		if(budget == 0u) return CTL::SearchStatus::Searching;
+		const Index v = queue.Pop();
+		if(context.State(v) == CTL::VertexState::Black) continue;
+		context.Close(v);
+		--budget;
+		const int x = int(v % this->width), y = int(v / this->width);
+		const float distance = context.Distance(v);
+		const size_t count = this->Directions(x, y, context.Parent(v), directions);
+		for(size_t i = 0u; i < count; ++i)
+		{
+			const Index u = this->Jump(x + directions[i][0], y + directions[i][1], directions[i][0], directions[i][1], end);
+			if(u == None || context.State(u) == CTL::VertexState::Black) continue;
+			const int ux = int(u % this->width), uy = int(u / this->width);
+			const float score = distance + GridDistance(ux - x, uy - y);
+			if(score >= context.Distance(u)) continue;
+			context.Relax(u, v, score);
+			queue.Push(u, score + GridDistance(ux - gx, uy - gy));
+		}
+	}
+	return CTL::SearchStatus::Failed;
+}
+
+bool JumpPointSearch::SearchPath(Index begin, Index end, const GridSearch& context, std::vector<Index>& path) const
+{
+	if(!context.Unwind(begin, end, path)) return false;
+
+	//Jump points are joined by straight or diagonal runs, expand them in place from the back
+	size_t total = 0u;
+	Index next = begin;
+	for(size_t i = path.size(); i-- > 0u;)
+	{
+		total += size_t(std::max(std::abs(int(path[i] % this->width) - int(next % this->width)),
+			std::abs(int(path[i] / this->width) - int(next / this->width))));
+		next = path[i];
+	}
+	size_t back = total;
+	next = begin;
+	const size_t jumps = path.size();
+	path.resize(total);
+	for(size_t i = jumps; i-- > 0u;)
+	{
+		const Index jump = path[i];
+		int x = int(next % this->width), y = int(next / this->width);
+		const int dx = Sign(int(jump % this->width) - x), dy = Sign(int(jump / this->width) - y);
+		do
+		{
+			x += dx;
+			y += dy;
+			path[--back] = this->Cell(x, y);
+		}
+		while(this->Cell(x, y) != jump);
+		next = jump;
+	}
+	return true;
+}
+
+bool JumpPointSearch::Search(Index begin, Index end, GridSearch& context, std::vector<Index>& path) const
+{
+	path.clear();
+	if(!this->SearchBegin(begin, end, context)) return false;
+	size_t budget = std::numeric_limits<size_t>::max();
+	if(this->SearchResume(end, context, budget) != CTL::SearchStatus::Found) return false;
+	return this->SearchPath(begin, end, context, path);
+}
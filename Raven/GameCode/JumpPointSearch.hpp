@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "GridGraph.hpp"
+
+//Jump Point Search over uniform 8-connected grid of GridCells, diagonal moves never cut corners.
+//Cells with a grid move missing from the navgraph (edge blocked by obstacle corner) are left out,
+//so every step of returned path is a navgraph edge.
+class JumpPointSearch
+{
+public:
+	using Index = GridSearch::Index;
+	static constexpr Index None = GridSearch::None;
+
+private:
+	int width = 0, height = 0;
+	std::vector<std::uint8_t> walkable;
+
+	bool Walkable(int x, int y) const
+	{
+		return x >= 0 && y >= 0 && x < this->width && y < this->height && this->walkable[y * this->width + x];
+	}
+
+	Index Cell(int x, int y) const
+	{
+		return Index(y * this->width + x);
+	}
+
+	Index JumpStraight(int x, int y, int dx, int dy, Index goal) const;
+	Index Jump(int x, int y, int dx, int dy, Index goal) const;
+	size_t Directions(int x, int y, Index parent, int (&directions)[8][2]) const;
+
+public:
+	//cells are row major: cells[y * width + x]
+	void Build(const GridCell* cells, size_t width, size_t height);
+
+	bool Walkable(Index cell) const;
+	Index CellIndex(b2Vec2 position) const;
+	b2Vec2 CellCentre(Index cell) const;
+
+	//Fills path with cells from end to begin (begin excluded), one cell per grid step.
+	//Returns false when begin or end is not walkable or end is unreachable.
+	bool Search(Index begin, Index end, GridSearch& context, std::vector<Index>& path) const;
+
+	//Resumable Search: SearchBegin (false when begin or end is not walkable), SearchResume until it
+	//stops returning Searching, then SearchPath. Resume expands at most budget jump points.
+	bool SearchBegin(Index begin, Index end, GridSearch& context) const;
+	CTL::SearchStatus SearchResume(Index end, GridSearch& context, size_t& budget) const;
+	bool SearchPath(Index begin, Index end, const GridSearch& context, std::vector<Index>& path) const;
+};
@@ -51,11 +51,14 @@ void MoveAwayFromObstacle::performLogic()
 		case SGE::ShapeType::None: break;
 		case SGE::ShapeType::Quad:
 		{
-			for(auto& wall : reinterpret_cast<QuadObstacle*>(w)->getEdges())
+			for(RavenBot* mo : this->movers)
 			{
-				for(RavenBot* mo : this->movers)
+				const float fradius = mo->getShape()->getRadius();
+				//Only edges of this obstacle close to the bot, from the static edge tree
+				this->world->forEachStaticEdge(mo->getPosition(), fradius, [this, w, mo, fradius](const EdgeTree::Entry& entry)
 				{
-					float fradius = mo->getShape()->getRadius();
+					if(entry.owner != w) return;
+					const Edge& wall = entry.edge;
 					b2Vec2 pos = mo->getPosition();
 					if(PointToLineDistance(pos, wall.From(), wall.To()) < fradius)
 					{
@@ -74,7 +77,7 @@ void MoveAwayFromObstacle::performLogic()
 							mo->setPosition(pos + ((fradius - pen) * radius));
 						}
 					}
-				}
+				});
 			}
 		}
 		default: break;
@@ -82,59 +85,99 @@ void MoveAwayFromObstacle::performLogic()
 	}
 }
 
-SeparateBots::SeparateBots(World* const world, std::vector<RavenBot>* const movers): Logic(SGE::LogicPriority::Highest), world(world), movers(movers)
+PartitionSync::PartitionSync(World* const world): Logic(SGE::LogicPriority::Highest), world(world)
+{}
+
+void PartitionSync::performLogic()
+{
+	this->world->SyncMovers();
+}
+
+NeighbourListUpdate::NeighbourListUpdate(World* const world, std::vector<RavenBot>* const movers): Logic(SGE::LogicPriority::Highest), world(world), movers(movers)
+{}
+
+void NeighbourListUpdate::performLogic()
 {
-	colliding.reserve(10);
+	this->world->UpdateNeighbourList(*this->movers);
+}
+
+SeparateBots::SeparateBots(World* const world, std::vector<RavenBot>* const movers, ThreadPool& pool)
+	: Logic(SGE::LogicPriority::Highest), world(world), movers(movers), pool(pool),
+	colliding(pool.Size() + 1u), contacts(pool.Size() + 1u)
+{
+	for(std::vector<RavenBot*>& buffer : this->colliding)
+	{
+		buffer.reserve(10);
+	}
 }
 
 void SeparateBots::performLogic()
 {
-	float baseRadius = 0.f;
-	b2Vec2 basePosition = b2Vec2_zero;
-	float otherRadius = 0.f;
-	b2Vec2 otherPosition = b2Vec2_zero;
-	for (RavenBot& mo : *this->movers)
-	{
-		baseRadius = mo.getShape()->getRadius();
-		basePosition = mo.getPosition();
-		this->colliding.clear();
-		this->world->getNeighbours(this->colliding, &mo, 2.f * baseRadius);
-		if (this->colliding.empty()) continue;
-		for (RavenBot* other : this->colliding)
-		{
-			otherPosition = other->getPosition();
-			otherRadius = other->getShape()->getRadius();
-			b2Vec2 toOther = otherPosition - basePosition;
-			float dist = toOther.Length();
-			float radius = baseRadius + otherRadius;
-			if (dist < radius)
+	std::vector<RavenBot>& bots = *this->movers;
+	//Movers partition stores centres, its queries and the neighbour list only read, so chunks query concurrently
+	this->pool.ParallelFor(bots.size(), [this, &bots](size_t chunk, size_t begin, size_t end)
+	{
+		std::vector<RavenBot*>& colliding = this->colliding[chunk];
+		std::vector<Contact>& contacts = this->contacts[chunk];
+		contacts.clear();
+		for(size_t i = begin; i < end; ++i)
+		{
+			RavenBot& mo = bots[i];
+			const float baseRadius = mo.getShape()->getRadius();
+			const b2Vec2 basePosition = mo.getPosition();
+			this->world->getNeighbours(colliding, &mo, baseRadius);
+			for(RavenBot* other : colliding)
 			{
-				toOther *= 0.5f * (radius - dist) / dist;
-				other->setPosition(otherPosition + toOther);
-				mo.setPosition(basePosition - toOther);
+				//Every pair once, from its lower index
+				const size_t j = size_t(other - bots.data());
+				if(j <= i || j >= bots.size()) continue;
+				b2Vec2 toOther = other->getPosition() - basePosition;
+				const float dist = toOther.Length();
+				const float radius = baseRadius + other->getShape()->getRadius();
+				if(dist > 0.f && dist < radius)
+				{
+					toOther *= 0.5f * (radius - dist) / dist;
+					contacts.push_back(Contact{std::uint32_t(i), std::uint32_t(j), toOther});
+				}
 			}
 		}
+	});
+	this->corrections.assign(bots.size(), b2Vec2_zero);
+	for(const std::vector<Contact>& contacts : this->contacts)
+	{
+		for(const Contact& contact : contacts)
+		{
+			this->corrections[contact.a] -= contact.push;
+			this->corrections[contact.b] += contact.push;
+		}
+	}
+	for(size_t i = 0u; i < bots.size(); ++i)
+	{
+		if(this->corrections[i] == b2Vec2_zero) continue;
+		bots[i].setPosition(bots[i].getPosition() + this->corrections[i]);
 	}
 }
 
 void MoveAwayFromWall::CollideWithWall(RavenBot& mo) const
 {
-	for (std::pair<SGE::Object*, Edge>& wall: this->world->getWalls())
+	const float fradius = mo.getShape()->getRadius();
+	this->world->forEachStaticEdge(mo.getPosition(), fradius, [this, &mo, fradius](const EdgeTree::Entry& entry)
 	{
-		float fradius = mo.getShape()->getRadius();
+		if(entry.edge.Type() == Wall::Invalid) return;
+		const Wall& wall = entry.edge;
 		b2Vec2 pos = mo.getPosition();
-		if(PointToLineDistance(pos, wall.second.From(), wall.second.To()) < fradius)
+		if(PointToLineDistance(pos, wall.From(), wall.To()) < fradius)
 		{
 			float dist;
 			b2Vec2 intersect;
-			b2Vec2 radius = fradius * -wall.second.Normal();
-			if(LineIntersection(pos, pos + radius, wall.second.From(), wall.second.To(), dist, intersect))
+			b2Vec2 radius = fradius * -wall.Normal();
+			if(LineIntersection(pos, pos + radius, wall.From(), wall.To(), dist, intersect))
 			{
 				intersect -= pos + radius;
 				mo.setPosition(pos + intersect);
 			}
 		}
-	}
+	});
 }
 
 void MoveAwayFromWall::performLogic()
@@ -196,87 +239,65 @@ RocketLogic::RocketLogic(RavenGameState* gs, World* w): Logic(SGE::LogicPriority
 void RocketLogic::performLogic()
 {
 	if(this->gs->rockets.empty()) return;
+	constexpr float hitRadius = 0.5f * Rocket::Height();
 	for (Rocket* rocket: this->gs->rockets)
 	{
-		b2Vec2 velocity = rocket->Speed() * rocket->Heading();
-		auto oldPos = rocket->getPosition();
-		rocket->setPosition(oldPos + SGE::delta_time * velocity);
-		this->world->UpdateRocket(rocket, oldPos);
-		std::vector<RavenBot*> bots;
-		constexpr float hitRadius = 0.5f * Rocket::Height();
-		b2Vec2 hitSpot = rocket->getPosition() + (hitRadius * rocket->Heading());
-		this->world->getNeighbours(bots, hitSpot, hitRadius);
-		if(!bots.empty())
+		const b2Vec2 oldPos = rocket->getPosition();
+		const b2Vec2 motion = this->gs->clock.Delta() * rocket->Speed() * rocket->Heading();
+		//Circle in front of the rocket is swept along its motion and the rocket stops at the first contact,
+		//so it does not pass through thin walls or bots however far it moves in a tick
+		const b2Vec2 from = oldPos + hitRadius * rocket->Heading();
+		const b2Vec2 centre = from + 0.5f * motion;
+		const float reach = 0.5f * motion.Length() + hitRadius;
+		float toi = 1.f, t0, t1;
+		bool hit = false;
+		auto contact = [&toi, &hit](float enter, float leave)
+		{
+			float t;
+			if(!TimeOfImpact(enter, leave, t) || t > toi) return;
+			toi = t;
+			hit = true;
+		};
+		this->world->forEachNeighbour(centre, reach, [&](RavenBot* bot)
 		{
-			rocket->Prime();
-			continue;
-		}
-		auto obstacles = this->world->getObstacles(hitSpot, hitRadius);
-		for(SGE::Object* ob : obstacles)
+			if(CircleInterval(from, motion, bot->getPosition(), hitRadius + bot->getShape()->getRadius(), t0, t1))
+				contact(t0, t1);
+		});
+		this->world->forEachStaticEdge(centre, reach, [&](const EdgeTree::Entry& entry)
+		{
+			if(CapsuleInterval(from, motion, entry.edge.From(), entry.edge.To(), hitRadius, t0, t1))
+				contact(t0, t1);
+		});
+		this->world->forEachObstacle(centre, reach, [&](SGE::Object* ob)
 		{
-			if(ob == rocket) continue;
-			if(rocket->IsPrimed()) break;
+			if(ob == rocket) return;
 			auto& obShape = *ob->getShape();
 			switch(obShape.getType())
 			{
+			case SGE::ShapeType::Circle:
+			{
+				if(CircleInterval(from, motion, ob->getPosition(), hitRadius + obShape.getRadius(), t0, t1))
+					contact(t0, t1);
+				break;
+			}
+			//Other rockets are only tested where this one ends up
 			case SGE::ShapeType::Rectangle:
 			{
+				const b2Vec2 hitSpot = from + motion;
 				b2Vec2 hitVec = PointToLocalSpace(hitSpot, b2Mul(b2Rot(ob->getOrientation()), {1.f, 0.f}), ob->getPosition());
 				b2Vec2 halves = 0.5f * ob->getScale();
 				b2Vec2 penPoint = b2Clamp(hitVec, -halves, halves);
 				if(b2DistanceSquared(penPoint, hitSpot) < hitRadius * hitRadius)
-				{
-					rocket->Prime();
-				}
-				break;
-			}
-			case SGE::ShapeType::Circle:
-			{
-				b2Vec2 toMover = hitSpot - ob->getPosition();
-				float dist = toMover.Length();
-				float radius = hitRadius + obShape.getRadius();
-				if(dist < radius)
-				{
-					rocket->Prime();
-				}
-				break;
-			}
-			case SGE::ShapeType::None: break;
-			case SGE::ShapeType::Quad:
-			{
-				for(auto& wall : reinterpret_cast<QuadObstacle*>(ob)->getEdges())
-				{
-					if(PointToLineDistance(hitSpot, wall.From(), wall.To()) < hitRadius)
-					{
-						float dist;
-						b2Vec2 intersect;
-						b2Vec2 radius = hitRadius * -wall.Normal();
-						if(LineIntersection(hitSpot, hitSpot + radius, wall.From(), wall.To(), dist, intersect))
-						{
-							rocket->Prime();
-						}
-					}
-				}
+					contact(1.f, 1.f);
 				break;
 			}
+			//Quad edges are static edges
 			default: break;
 			}
-		}
-		if(rocket->IsPrimed()) continue;
-		for(std::pair<SGE::Object*, Edge>& wall : this->world->getWalls())
-		{
-			if(PointToLineDistance(hitSpot, wall.second.From(), wall.second.To()) < hitRadius)
-			{
-				float dist;
-				b2Vec2 intersect;
-				b2Vec2 radius = hitRadius * -wall.second.Normal();
-				if(LineIntersection(hitSpot, hitSpot + radius, wall.second.From(), wall.second.To(), dist, intersect))
-				{
-					rocket->Prime();
-					break;
-				}
-			}
-		}
+		});
+		rocket->setPosition(oldPos + toi * motion);
+		this->world->UpdateRocket(rocket, oldPos);
+		if(hit) rocket->Prime();
 	}
 	std::stack<Rocket*> primed;
 	for(Rocket* rocket : this->gs->rockets)
@@ -287,14 +308,13 @@ void RocketLogic::performLogic()
 	while(!primed.empty())
 	{
 		Rocket* rocket = primed.top();
-		std::vector<RavenBot*> bots;
-		this->world->getNeighbours(bots, rocket->getPosition(), Rocket::Radius());
-		for(RavenBot* bot : bots)
+		this->world->getNeighbours(this->bots, rocket->getPosition(), Rocket::Radius());
+		for(RavenBot* bot : this->bots)
 		{
 			bot->Damage(RavenBot::LauncherDamage);
 		}
-		std::vector<Rocket*> rockets(this->world->getRockets(rocket->getPosition(), Rocket::Radius()));
-		for(Rocket* otherRocket : rockets)
+		this->world->getRockets(this->rockets, rocket->getPosition(), Rocket::Radius());
+		for(Rocket* otherRocket : this->rockets)
 		{
 			otherRocket->Prime();
 		}
@@ -305,7 +325,7 @@ void RocketLogic::performLogic()
 	{
 		if(explosion->RemainingTime() > 0.f)
 		{
-			explosion->Expire(SGE::delta_time);
+			explosion->Expire(this->gs->clock.Delta());
 		}
 		else
 		{
@@ -322,16 +342,21 @@ void RocketLogic::performLogic()
 
 void BotLogic::updateEnemies(RavenBot& bot)
 {
-	for(auto& enemy : this->gs->bots)
+	const size_t observer = size_t(&bot - this->gs->bots.data());
+	for(size_t target = 0u; target < this->gs->bots.size(); ++target)
 	{
+		RavenBot& enemy = this->gs->bots[target];
 		if(&bot == &enemy) continue;
 		b2Vec2 botPos = bot.getPosition();
 		b2Vec2 enemyPos = enemy.getPosition();
-		b2Vec2 hit = enemyPos - botPos;
-		hit.Normalize();
+		b2Vec2 direction = enemyPos - botPos;
+		//Ray towards enemy centre meets it before reaching that far
+		const float distance = direction.Normalize();
 		if(bot.enemies.find(&enemy) != bot.enemies.end())
 		{
-			RavenBot* hitBot = this->world->RaycastBot(&bot, botPos, hit, hit);
+			RavenBot* hitBot;
+			if(!this->visibility.SeenBot(observer, target, hitBot))
+				hitBot = this->gs->pvs.Visible(botPos, enemyPos) ? this->world->RaycastBot(&bot, botPos, direction, distance).entity : nullptr;
 			if(!hitBot)
 			{
 				bot.enemies.erase(&enemy);
@@ -341,9 +366,11 @@ void BotLogic::updateEnemies(RavenBot& bot)
 		}
 		else
 		{
-			if (b2Abs(b2Atan2(b2Cross(bot.getHeading(), hit), b2Dot(bot.getHeading(), hit))) < 0.25f * b2_pi)
+			if(InFieldOfView(bot.getHeading(), direction))
 			{
-				RavenBot* hitBot = this->world->RaycastBot(&bot, botPos, hit, hit);
+				RavenBot* hitBot;
+				if(!this->visibility.SeenBot(observer, target, hitBot))
+					hitBot = this->gs->pvs.Visible(botPos, enemyPos) ? this->world->RaycastBot(&bot, botPos, direction, distance).entity : nullptr;
 				if(hitBot)
 				{
 					bot.enemies.insert(hitBot);
@@ -355,16 +382,20 @@ void BotLogic::updateEnemies(RavenBot& bot)
 
 void BotLogic::updateItems(RavenBot& bot)
 {
-	for(Item* item : this->gs->items)
+	const size_t observer = size_t(&bot - this->gs->bots.data());
+	for(size_t index = 0u; index < this->gs->items.size(); ++index)
 	{
+		Item* item = this->gs->items[index];
 		b2Vec2 botPos = bot.getPosition();
 		b2Vec2 itemPos = item->getPosition();
-		b2Vec2 hit = itemPos - botPos;
+		b2Vec2 direction = itemPos - botPos;
 		if(bot.items.find(item) == bot.items.end())
 		{
-			if(b2Abs(b2Atan2(b2Cross(bot.getHeading(), hit), b2Dot(bot.getHeading(), hit))) < 0.25f * b2_pi)
+			if(InFieldOfView(bot.getHeading(), direction))
 			{
-				Item* hitItem = this->world->RaycastItem(botPos, hit, hit);
+				Item* hitItem;
+				if(!this->visibility.SeenItem(observer, index, hitItem))
+					hitItem = this->gs->pvs.Visible(botPos, itemPos) ? this->world->RaycastItem(botPos, direction, direction.Length()).entity : nullptr;
 				if(hitItem)
 				{
 					bot.items.insert(hitItem);
@@ -483,8 +514,9 @@ void BotLogic::updateState(RavenBot& bot)
 
 void BotLogic::pickItems(RavenBot& bot)
 {
-	auto items = this->world->getItems(&bot);
-	for(Item* item : items)
+	this->world->getItems(this->items, &bot);
+	if(!this->items.empty()) this->visibility.InvalidateItems();
+	for(Item* item : this->items)
 	{
 		item->useItem(bot);
 		this->gs->UseItem(item);
@@ -495,6 +527,7 @@ void BotLogic::ResetBot(RavenBot& bot)
 {
 	b2Vec2 newPos = this->gs->GetRandomVertex(bot.getPosition(), 30.f, false)->Label().position;
 	bot.Respawn(newPos);
+	this->visibility.Invalidate();
 	for(auto& enemy : this->gs->bots)
 	{
 		enemy.enemies.erase(&bot);
@@ -517,28 +550,47 @@ void BotLogic::updateBotState(RavenBot& bot)
 	this->updateItems(bot);
 	this->updateState(bot);
 	
-	bot.Reloading(SGE::delta_time);
+	bot.Reloading(this->gs->clock.DecisionDelta());
 	bot.ClearHit();
 }
 
 void BotLogic::FireRG(RavenBot& bot)
 {
 	if(!bot.FireRG()) return;
-	b2Vec2 pos = bot.getPosition();
 	b2Vec2 direction = bot.getHeading();
 	direction = b2Mul(b2Rot(this->randAngle()), direction);
-	b2Vec2 hitPos = b2Vec2_zero;
-	RavenBot* hitObject = this->world->RaycastBot(&bot, pos, direction, hitPos);
-	bot.RailgunTrace->setVisible(true);
-	b2Vec2 beam = hitPos - pos;
-	bot.RailgunTrace->setPosition(pos + 0.5f * beam);
-	bot.RailgunTrace->setOrientation(beam.Orientation());
-	bot.RailgunTrace->setShape(SGE::Shape::Rectangle(beam.Length(), 0.1f, true));
+	this->shots.push_back(Shot{&bot, bot.getPosition(), direction, RayHit<RavenBot>{}});
+}
 
-	if(hitObject)
+void BotLogic::ResolveShots()
+{
+	if(this->shots.empty()) return;
+	//Shots are traced together while the world does not change, so their order does not matter
+	this->world->getStaticEdges();
+	this->pool.ParallelFor(this->shots.size(), [this](size_t chunk, size_t begin, size_t end)
 	{
-		hitObject->Damage(RavenBot::RailgunDamage);
+		for(size_t i = begin; i < end; ++i)
+		{
+			Shot& shot = this->shots[i];
+			shot.hit = this->world->RaycastBot(shot.shooter, shot.from, shot.direction, this->rayBuffers[chunk]);
+		}
+	});
+	for(const Shot& shot : this->shots)
+	{
+		SGE::Object* trace = shot.shooter->RailgunTrace;
+		trace->setVisible(true);
+		//A miss leaves the hit point at the origin, so the beam ends at the ray range instead
+		const b2Vec2 end = shot.hit ? shot.hit.point : shot.from + rayDistance * shot.direction;
+		b2Vec2 beam = end - shot.from;
+		trace->setPosition(shot.from + 0.5f * beam);
+		trace->setOrientation(beam.Orientation());
+		trace->setShape(SGE::Shape::Rectangle(beam.Length(), 0.1f, true));
+		if(shot.hit.entity)
+		{
+			shot.hit.entity->Damage(RavenBot::RailgunDamage);
+		}
 	}
+	this->shots.clear();
 }
 
 void BotLogic::FireRL(RavenBot& bot)
@@ -552,18 +604,11 @@ void BotLogic::FireRL(RavenBot& bot)
 
 void BotLogic::UpdateEnemy(RavenBot& bot)
 {
-	float dist = std::numeric_limits<float>::max();
-	b2Vec2 pos = bot.getPosition();
-	RavenBot* target = nullptr;
-	for(auto enemy : bot.enemies)
+	if(bot.enemies.empty()) return;
+	RavenBot* target = this->world->nearestMover(bot.getPosition(), [&bot](RavenBot* other)
 	{
-		float enemyDist = b2DistanceSquared(pos, enemy->getPosition());
-		if( enemyDist < dist)
-		{
-			dist = enemyDist;
-			target = enemy;
-		}
-	}
+		return bot.enemies.count(other) != 0u;
+	});
 	if(target)
 	{
 		bot.getSteering()->setEnemy(target);
@@ -572,47 +617,46 @@ void BotLogic::UpdateEnemy(RavenBot& bot)
 
 void BotLogic::GetItem(RavenBot& bot, Item::IType type)
 {
+	if(bot.IsWaitingForPath()) return;
 	b2Vec2 pos = bot.getPosition();
-	Item* closestItem = nullptr;
-	float distance = std::numeric_limits<float>::max();
-	for(Item* item : bot.items)
+	Item* closestItem = bot.items.empty() ? nullptr : this->world->nearestItem(pos, [&bot, type](Item* item)
 	{
-		if(item->Type() == type)
-		{
-			float newDist = b2DistanceSquared(pos, item->getPosition());
-			if(newDist < distance)
-			{
-				closestItem = item;
-				distance = newDist;
-			}
-		}
-	}
+		return item->Type() == type && bot.items.count(item) != 0u;
+	});
 	if(closestItem)
 	{
 		if(!bot.IsFollowingPath())
 		{
-			GridVertex* begin = gs->GetVertex(pos);
-			GridVertex* end = gs->GetVertex(closestItem->getPosition());
-			bot.getSteering()->NewPath(std::move(this->gs->GetPath(begin, end)));
+			this->RequestPath(bot, gs->GetVertex(closestItem->getPosition()));
 		}
 		else if(b2DistanceSquared(closestItem->getPosition(), bot.getSteering()->getPath().End()) > 0.1)
 		{
-			GridVertex* begin = gs->GetVertex(pos);
-			GridVertex* end = gs->GetVertex(closestItem->getPosition());
-			bot.getSteering()->NewPath(std::move(this->gs->GetPath(begin, end)));
+			this->RequestPath(bot, gs->GetVertex(closestItem->getPosition()));
 		}
 	}
 	else
 	{
 		if(!bot.IsFollowingPath())
 		{
-			GridVertex* begin = gs->GetVertex(pos);
-			GridVertex* end = gs->GetRandomVertex(pos,25,true);
-			bot.getSteering()->NewPath(std::move(this->gs->GetPath(begin, end)));
+			this->RequestPath(bot, gs->GetRandomVertex(pos,25,true));
 		}
 	}
 }
 
+void BotLogic::RequestPath(RavenBot& bot, GridVertex* end)
+{
+	GridVertex* begin = this->gs->GetVertex(bot.getPosition());
+	Path cached = this->gs->pathCache.Find(begin, end);
+	if(cached.Empty())
+	{
+		this->paths->Submit(bot, begin, end);
+		return;
+	}
+	//Request still searched for this bot is abandoned
+	bot.SetPathRequest(NoPathRequest);
+	bot.getSteering()->NewPath(std::move(cached));
+}
+
 void BotLogic::updateBot(RavenBot& bot)
 {
 	this->updateBotState(bot);
@@ -621,11 +665,9 @@ void BotLogic::updateBot(RavenBot& bot)
 	{
 	case BotState::Wandering:
 	{
-		if(!bot.IsFollowingPath())
+		if(!bot.IsFollowingPath() && !bot.IsWaitingForPath())
 		{
-			GridVertex* begin = gs->GetVertex(bot.getPosition());
-			GridVertex* end = gs->GetRandomVertex(bot.getPosition(),25.f,true);
-			bot.getSteering()->NewPath(std::move(this->gs->GetPath(begin, end)));
+			this->RequestPath(bot, gs->GetRandomVertex(bot.getPosition(),25.f,true));
 		}
 		break;
 	}
@@ -657,10 +699,8 @@ void BotLogic::updateBot(RavenBot& bot)
 			UpdateEnemy(bot);
 		}
 		const RavenBot* enemy = bot.getSteering()->getEnemy();
-		if(!enemy || !bot.IsFollowingPath()) break;
-		GridVertex* begin = this->gs->GetVertex(bot.getPosition());
-		GridVertex* end = this->gs->GetRandomVertex(enemy->getPosition(),30.f,false);
-		bot.getSteering()->NewPath(this->gs->GetPath(begin, end));
+		if(!enemy || !bot.IsFollowingPath() || bot.IsWaitingForPath()) break;
+		this->RequestPath(bot, this->gs->GetCoverVertex(enemy->getPosition(), 30.f));
 		break;
 	}
 	case BotState::GettingAmmo:
@@ -689,12 +729,29 @@ void BotLogic::updateBot(RavenBot& bot)
 	}
 }
 
+BotLogic::BotLogic(World* world, RavenGameState* gs)
+	: Logic(SGE::LogicPriority::Highest), world(world), gs(gs), pool(gs->SimulationPool()),
+	visibility(world, &gs->pvs, pool), rayBuffers(pool.Size() + 1u)
+{
+	if(gs->pathThreads > 0u)
+		this->paths.reset(new AsyncPathPlanner(gs, gs->pathThreads));
+	else
+		this->paths.reset(new PathRequestQueue(gs));
+	constexpr float spread = 0.01f;
+	randAngle = std::bind(std::uniform_real_distribution<float>{-spread * b2_pi, spread * b2_pi}, std::default_random_engine{gs->seed});
+}
+
 void BotLogic::performLogic()
 {
+	//Searches advance, or finished ones are collected, every tick so decisions find their paths sooner
+	this->paths->Update();
+	if(!this->gs->clock.IsDecisionTick()) return;
+	this->visibility.Update(this->gs->bots, this->gs->items);
 	for(RavenBot& bot: this->gs->bots)
 	{
 		this->updateBot(bot);
 	}
+	this->ResolveShots();
 }
 
 void ItemLogic::performLogic()
@@ -708,7 +765,40 @@ void ItemLogic::performLogic()
 		}
 		else if(!item->getVisible())
 		{
-			item->Reload(SGE::delta_time);
+			item->Reload(this->gs->clock.Delta());
 		}
 	}
 }
+
+SimulationStep::SimulationStep(SimulationClock* clock): Logic(SGE::LogicPriority::Highest), clock(clock)
+{}
+
+SimulationStep::~SimulationStep()
+{
+	for(SGE::Logic* l : this->logics)
+	{
+		delete l;
+	}
+}
+
+void SimulationStep::AddLogic(SGE::Logic* logic)
+{
+	this->logics.push_back(logic);
+}
+
+void SimulationStep::Step()
+{
+	this->clock->BeginTick();
+	for(SGE::Logic* l : this->logics)
+	{
+		l->performLogic();
+	}
+}
+
+void SimulationStep::performLogic()
+{
+	for(unsigned steps = this->clock->Advance(SGE::delta_time); steps > 0u; --steps)
+	{
+		this->Step();
+	}
+}
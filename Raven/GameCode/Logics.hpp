@@ -8,10 +8,15 @@
 #include <Utils/Timing/sge_fps_limiter.hpp>
 #include <vector>
 #include <random>
+#include <memory>
+#include <cstdint>
 
 #include "RavenBot.hpp"
 #include "Objects.hpp"
 #include "World.hpp"
+#include "SimulationClock.hpp"
+#include "PathRequests.hpp"
+#include "Visibility.hpp"
 
 namespace SGE
 {
@@ -39,15 +44,50 @@ public:
 	void performLogic() override;
 };
 
+//Moves bots which moved during the last tick to their new partition cells in one sweep, runs first in the tick
+class PartitionSync : public SGE::Logic
+{
+protected:
+	World* world;
+public:
+	explicit PartitionSync(World* const world);
+
+	void performLogic() override;
+};
+
+//Runs after PartitionSync, so bot neighbour queries of the tick are answered from World's neighbour list
+class NeighbourListUpdate : public SGE::Logic
+{
+protected:
+	World* world;
+	std::vector<RavenBot>* movers;
+public:
+	NeighbourListUpdate(World* const world, std::vector<RavenBot>* const movers);
+
+	void performLogic() override;
+};
+
+//Pushes overlapping bots apart. Contacts and their corrections are found on worker threads from positions at the
+//start of the pass, then summed in bot order and applied, so result does not depend on thread count
 class SeparateBots : public SGE::Logic
 {
 protected:
+	struct Contact
+	{
+		std::uint32_t a, b;
+		//Moves b, a is moved by the opposite
+		b2Vec2 push;
+	};
 	World* world;
 	std::vector<RavenBot>* movers;
-	std::vector<RavenBot*> colliding;
+	ThreadPool& pool;
+	//Per chunk buffers
+	std::vector<std::vector<RavenBot*>> colliding;
+	std::vector<std::vector<Contact>> contacts;
+	std::vector<b2Vec2> corrections;
 public:
 
-	SeparateBots(World* const world, std::vector<RavenBot>* const movers);
+	SeparateBots(World* const world, std::vector<RavenBot>* const movers, ThreadPool& pool);
 
 	void performLogic() override;
 };
@@ -109,6 +149,9 @@ class RocketLogic: public SGE::Logic
 protected:
 	RavenGameState* gs;
 	World* world;
+	//Query buffers reused between ticks
+	std::vector<RavenBot*> bots;
+	std::vector<Rocket*> rockets;
 public:
 	RocketLogic(RavenGameState* gs, World* w);
 
@@ -122,6 +165,22 @@ class BotLogic: public SGE::Logic
 protected:
 	World* world;
 	RavenGameState* gs;
+	std::unique_ptr<PathService> paths;
+	//Railgun shot fired during decision pass, traced and applied after all bots decided
+	struct Shot
+	{
+		RavenBot* shooter;
+		b2Vec2 from, direction;
+		RayHit<RavenBot> hit;
+	};
+	//Simulation workers tracing rays of decision pass
+	ThreadPool& pool;
+	//Lines of sight of the current decision pass
+	Visibility visibility;
+	std::vector<Shot> shots;
+	//Per chunk raycast buffers
+	std::vector<std::vector<RavenBot*>> rayBuffers;
+	std::vector<Item*> items;
 
 	void updateEnemies(RavenBot& bot);
 	void updateItems(RavenBot& bot);
@@ -129,20 +188,18 @@ protected:
 	void pickItems(RavenBot& bot);
 	void ResetBot(RavenBot& bot);
 	void updateBotState(RavenBot& bot);
+	//Queues railgun shot, ResolveShots traces it
 	void FireRG(RavenBot& bot);
+	void ResolveShots();
 	void FireRL(RavenBot& bot);
 	void UpdateEnemy(RavenBot& bot);
 	void GetItem(RavenBot& bot, Item::IType type);
+	void RequestPath(RavenBot& bot, GridVertex* end);
 	void updateBot(RavenBot& bot);
 	
 	std::function<float(void)> randAngle;
 public:
-	BotLogic(World* world, RavenGameState* gs)
-		: Logic(SGE::LogicPriority::Highest), world(world), gs(gs)
-	{
-		constexpr float spread = 0.01f;
-		randAngle = std::bind(std::uniform_real_distribution<float>{-spread * b2_pi, spread * b2_pi}, std::default_random_engine{std::random_device{}()});
-	}
+	BotLogic(World* world, RavenGameState* gs);
 
 	void performLogic() override;
 };
@@ -159,4 +216,19 @@ public:
 	void performLogic() override;
 };
 
+//Runs owned simulation logics at fixed timestep of the clock, as many ticks as frame time allows
+class SimulationStep: public SGE::Logic
+{
+protected:
+	SimulationClock* clock;
+	std::vector<SGE::Logic*> logics;
+public:
+	explicit SimulationStep(SimulationClock* clock);
+	~SimulationStep();
+
+	void AddLogic(SGE::Logic* logic);
+	void Step();
+	void performLogic() override;
+};
+
 #endif
@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+//Lock-free multiple producer, single consumer queue.
+//Producers push onto intrusive stack with CAS, consumer takes the whole stack at once and
+//reverses it, so items are consumed in push order.
+template<typename T>
+class MPSCQueue
+{
+	struct Node
+	{
+		T value;
+		Node* next;
+	};
+	std::atomic<Node*> head{nullptr};
+
+public:
+	MPSCQueue() = default;
+	MPSCQueue(const MPSCQueue&) = delete;
+	MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+	~MPSCQueue()
+	{
+		Node* node = this->head.exchange(nullptr);
+		while(node)
+		{
+			Node* next = node->next;
+			delete node;
+			node = next;
+		}
+	}
+
+	//Any thread
+	void Push(T value)
+	{
+		Node* node = new Node{std::move(value), this->head.load(std::memory_order_relaxed)};
+		while(!this->head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	//Consumer thread only, calls f for each item pushed so far
+	template<typename F>
+	size_t Drain(F f)
+	{
+		Node* node = this->head.exchange(nullptr, std::memory_order_acquire);
+		Node* reversed = nullptr;
+		while(node)
+		{
+			Node* next = node->next;
+			node->next = reversed;
+			reversed = node;
+			node = next;
+		}
+		size_t count = 0u;
+		while(reversed)
+		{
+			Node* next = reversed->next;
+			f(reversed->value);
+			delete reversed;
+			reversed = next;
+			++count;
+		}
+		return count;
+	}
+};
@@ -0,0 +1,57 @@
+#include "NeighbourList.hpp"
+
+NeighbourList::NeighbourList(float radius, float skin): radius(radius), skin(skin)
+{}
+
+size_t NeighbourList::Index(const RavenBot* bot) const
+{
+	if(!this->bots || bot < this->bots || bot >= this->bots + this->count) return this->count;
+	return size_t(bot - this->bots);
+}
+
+bool NeighbourList::Valid(const std::vector<RavenBot>& bots) const
+{
+	return this->valid && this->bots == bots.data() && this->count == bots.size();
+}
+
+void NeighbourList::Invalidate()
+{
+	this->valid = false;
+}
+
+void NeighbourList::Moved(const RavenBot* bot)
+{
+	if(!this->valid) return;
+	const size_t index = this->Index(bot);
+	if(index == this->count) return;
+	const float limit = 0.5f * this->skin;
+	if(b2DistanceSquared(bot->getPosition(), this->origins[index]) >= limit * limit)
+		this->valid = false;
+}
+
+bool NeighbourList::Gather(std::vector<RavenBot*>& res, const RavenBot* bot, float radius) const
+{
+	if(!this->valid || radius > this->radius) return false;
+	const size_t index = this->Index(bot);
+	if(index == this->count) return false;
+	res.clear();
+	const b2Vec2 position = bot->getPosition();
+	for(std::uint32_t i = this->offsets[index]; i < this->offsets[index + 1u]; ++i)
+	{
+		RavenBot* other = this->neighbours[i];
+		const float reach = radius + other->getShape()->getRadius();
+		if(b2DistanceSquared(position, other->getPosition()) < reach * reach)
+			res.push_back(other);
+	}
+	return true;
+}
+
+float NeighbourList::Radius() const
+{
+	return this->radius;
+}
+
+size_t NeighbourList::Builds() const
+{
+	return this->builds;
+}
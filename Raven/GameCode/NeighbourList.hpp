@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "RavenBot.hpp"
+
+//Verlet list of bot neighbours. Keeps every bot within radius + skin of each bot and stays valid until some
+//bot moves more than half the skin away from where it was at the build, so it is rebuilt only every few ticks.
+//Queries of up to radius filter their bot's list by current positions instead of walking the partition.
+class NeighbourList
+{
+	const RavenBot* bots = nullptr;
+	size_t count = 0u;
+	//Neighbours of bot i are neighbours[offsets[i]] .. neighbours[offsets[i + 1] - 1]
+	std::vector<std::uint32_t> offsets;
+	std::vector<RavenBot*> neighbours;
+	//Positions at the build
+	std::vector<b2Vec2> origins;
+	const float radius;
+	const float skin;
+	bool valid = false;
+	size_t builds = 0u;
+
+	//count when bot is not listed
+	size_t Index(const RavenBot* bot) const;
+public:
+	NeighbourList(float radius, float skin);
+
+	bool Valid(const std::vector<RavenBot>& bots) const;
+	//query(position, radius, visit) has to call visit with every bot overlapping the circle
+	template<typename Query>
+	void Build(std::vector<RavenBot>& bots, Query query)
+	{
+		this->bots = bots.data();
+		this->count = bots.size();
+		this->offsets.clear();
+		this->neighbours.clear();
+		this->origins.clear();
+		for(RavenBot& bot : bots)
+		{
+			this->offsets.push_back(std::uint32_t(this->neighbours.size()));
+			this->origins.push_back(bot.getPosition());
+			query(bot.getPosition(), this->radius + this->skin, [this, &bot](RavenBot* other)
+			{
+				if(other != &bot) this->neighbours.push_back(other);
+			});
+		}
+		this->offsets.push_back(std::uint32_t(this->neighbours.size()));
+		this->valid = true;
+		++this->builds;
+	}
+	void Invalidate();
+	//Invalidates list once bot leaves its skin
+	void Moved(const RavenBot* bot);
+
+	//Replaces res with bots overlapping circle of radius around bot, like World::getNeighbours.
+	//False when the list cannot answer and partition has to be queried
+	bool Gather(std::vector<RavenBot*>& res, const RavenBot* bot, float radius) const;
+
+	float Radius() const;
+	size_t Builds() const;
+};
@@ -77,6 +77,16 @@ public:
 	}
 };
 
+class RGTrace: public SGE::Object
+{
+public:
+	RGTrace(): Object(b2Vec2_zero, true)
+	{
+		this->Object::setVisible(false);
+	}
+	~RGTrace() = default;
+};
+
 class Item: public SGE::Object
 {
 public:
@@ -1,22 +1,89 @@
 #pragma once
 #include <vector>
+#include <functional>
+#include <memory>
+#include <cstdint>
 #include "Box2D/Common/b2Math.h"
 #include "GridGraph.hpp"
 
+//Pathfinder used to build Path
+enum class Planner
+{
+	AStar, JumpPoint, Hierarchical
+};
+
+//Ticket of path request, see PathRequestQueue
+using PathHandle = std::uint32_t;
+constexpr PathHandle NoPathRequest = 0u;
+
+//Waypoints are shared between copies and never changed once built, so copying Path (e.g. from PathCache)
+//does not allocate. Each Path walks its own prefix of the shared waypoints.
 class Path
 {
-	std::vector<b2Vec2> waypoints;
+public:
+	//Fills next part of path, ordered like waypoints, returns false when there is nothing left
+	using Refiner = std::function<bool(std::vector<b2Vec2>& segment)>;
+	using Waypoints = std::vector<b2Vec2>;
+private:
+	std::shared_ptr<const Waypoints> waypoints;
+	//Waypoints not reached yet, waypoints[remaining - 1] is the current one
+	size_t remaining = 0u;
 	b2Vec2 point;
+	Refiner refine;
+	b2Vec2 goal;
+
+	//Keeps at least two waypoints while refiner has more, so Finished stays false
+	void Refine()
+	{
+		if(this->refine && this->remaining < 2u)
+		{
+			//Copy on write, waypoints may be shared with copies of this path
+			Waypoints refined, segment;
+			if(this->remaining)
+				refined.assign(this->waypoints->begin(), this->waypoints->begin() + this->remaining);
+			while(this->refine && refined.size() < 2u)
+			{
+				if(!this->refine(segment))
+				{
+					this->refine = nullptr;
+					break;
+				}
+				refined.insert(refined.begin(), segment.begin(), segment.end());
+			}
+			this->remaining = refined.size();
+			this->waypoints = std::make_shared<const Waypoints>(std::move(refined));
+		}
+		if(this->remaining)
+			this->point = (*this->waypoints)[this->remaining - 1u];
+	}
 public:
 	Path(GridVertex* begin, GridVertex* end)
 	{
+		Waypoints waypoints;
 		while(begin != end)
 		{
 			waypoints.push_back(end->Label().position);
 			end = end->Parent();
 		}
-		if(!waypoints.empty())
-			this->point = this->waypoints.back();
+		*this = Path(std::move(waypoints));
+	}
+	//Waypoints ordered from end of path to the first waypoint
+	explicit Path(Waypoints&& waypoints)
+		: waypoints(std::make_shared<const Waypoints>(std::move(waypoints))), remaining(this->waypoints->size())
+	{
+		if(this->remaining)
+			this->point = this->waypoints->back();
+	}
+	//Walks the first count waypoints, which end where the whole path ends
+	Path(std::shared_ptr<const Waypoints> waypoints, size_t count): waypoints(std::move(waypoints)), remaining(count)
+	{
+		if(this->remaining)
+			this->point = (*this->waypoints)[this->remaining - 1u];
+	}
+	//Lazily refined path, goal is its known end point
+	Path(Refiner refiner, b2Vec2 goal): refine(std::move(refiner)), goal(goal)
+	{
+		this->Refine();
 	}
 	Path() = default;
 	Path(Path&&) = default;
@@ -31,27 +98,54 @@ public:
 	}
 	void SetNextWaypoint()
 	{
-		this->waypoints.pop_back();
-		if(!this->waypoints.empty())
-			this->point = this->waypoints.back();
+		if(this->remaining)
+			--this->remaining;
+		if(this->refine)
+			this->Refine();
+		else if(this->remaining)
+			this->point = (*this->waypoints)[this->remaining - 1u];
 	}
 	bool Finished() const
 	{
-		return waypoints.size() < 2u;
+		return this->remaining < 2u;
 	}
 
 	void Clear()
 	{
-		this->waypoints.clear();
+		this->waypoints.reset();
+		this->remaining = 0u;
+		this->refine = nullptr;
 	}
 
 	bool Empty() const
 	{
-		return this->waypoints.empty();
+		return this->remaining == 0u;
+	}
+
+	//True while refiner has parts of path not built yet
+	bool Lazy() const
+	{
+		return bool(this->refine);
+	}
+
+	//Waypoints not reached yet, i-th counted back from the end of path
+	size_t Size() const
+	{
+		return this->remaining;
+	}
+	b2Vec2 Waypoint(size_t i) const
+	{
+		return (*this->waypoints)[i];
+	}
+	//Last count waypoints of this path, sharing them. Refiner is not copied
+	Path Suffix(size_t count) const
+	{
+		return Path(this->waypoints, count);
 	}
 
 	b2Vec2 End() const
 	{
-		return !this->waypoints.empty() ? this->waypoints.front(): this->point;
+		if(this->refine) return this->goal;
+		return this->remaining ? this->waypoints->front(): this->point;
 	}
 };
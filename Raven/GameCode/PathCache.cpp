@@ -0,0 +1,127 @@
+#include "PathCache.hpp"
+
+#include <cmath>
+#include <iterator>
+
+namespace
+{
+	bool SameCell(b2Vec2 a, b2Vec2 b)
+	{
+		return std::floor(a.x) == std::floor(b.x) && std::floor(a.y) == std::floor(b.y);
+	}
+}
+
+PathCache::PathCache(size_t capacity): capacity(capacity)
+{
+	this->byKey.reserve(capacity);
+}
+
+PathCache::Key PathCache::MakeKey(GridCSR::Index begin, GridCSR::Index end)
+{
+	return Key(begin) << 32u | Key(end);
+}
+
+Path PathCache::Find(GridVertex* begin, GridVertex* end)
+{
+	const GridCSR::Index goal = GridCSR::Index(end->Index());
+	auto found = this->byKey.find(MakeKey(GridCSR::Index(begin->Index()), goal));
+	if(found != this->byKey.end())
+	{
+		this->entries.splice(this->entries.begin(), this->entries, found->second);
+		++this->hits;
+		return found->second->path;
+	}
+	const b2Vec2 start = begin->Label().position;
+	auto range = this->byGoal.equal_range(goal);
+	for(auto it = range.first; it != range.second; ++it)
+	{
+		const Path& path = it->second->path;
+		//Start itself is not a waypoint, so the rest of the path are waypoints before it
+		for(size_t i = 1u; i < path.Size(); ++i)
+		{
+			if(!SameCell(path.Waypoint(i), start)) continue;
+			this->entries.splice(this->entries.begin(), this->entries, it->second);
+			++this->hits;
+			++this->suffixHits;
+			return path.Suffix(i);
+		}
+	}
+	++this->misses;
+	return Path();
+}
+
+void PathCache::Insert(GridVertex* begin, GridVertex* end, const Path& path)
+{
+	if(path.Empty() || path.Lazy() || this->capacity == 0u) return;
+	const GridCSR::Index goal = GridCSR::Index(end->Index());
+	const Key key = MakeKey(GridCSR::Index(begin->Index()), goal);
+	auto found = this->byKey.find(key);
+	if(found != this->byKey.end())
+	{
+		found->second->path = path;
+		this->entries.splice(this->entries.begin(), this->entries, found->second);
+		return;
+	}
+	this->entries.push_front(Entry{key, path});
+	this->byKey.emplace(key, this->entries.begin());
+	this->byGoal.emplace(goal, this->entries.begin());
+	while(this->entries.size() > this->capacity)
+	{
+		this->Evict();
+	}
+}
+
+void PathCache::Evict()
+{
+	auto last = std::prev(this->entries.end());
+	this->byKey.erase(last->key);
+	auto range = this->byGoal.equal_range(GridCSR::Index(last->key));
+	for(auto it = range.first; it != range.second; ++it)
+	{
+		if(it->second != last) continue;
+		this->byGoal.erase(it);
+		break;
+	}
+	this->entries.pop_back();
+}
+
+void PathCache::Clear()
+{
+	this->entries.clear();
+	this->byKey.clear();
+	this->byGoal.clear();
+}
+
+void PathCache::SetCapacity(size_t capacity)
+{
+	this->capacity = capacity;
+	while(this->entries.size() > this->capacity)
+	{
+		this->Evict();
+	}
+}
+
+size_t PathCache::Capacity() const
+{
+	return this->capacity;
+}
+
+size_t PathCache::Size() const
+{
+	return this->entries.size();
+}
+
+size_t PathCache::Hits() const
+{
+	return this->hits;
+}
+
+size_t PathCache::SuffixHits() const
+{
+	return this->suffixHits;
+}
+
+size_t PathCache::Misses() const
+{
+	return this->misses;
+}
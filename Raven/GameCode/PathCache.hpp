@@ -0,0 +1,48 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include "GridGraph.hpp"
+#include "Path.hpp"
+
+//Found paths keyed by start and goal vertex, least recently used ones are evicted.
+//Paths are handed out as copies sharing waypoints, so hit does not allocate. When start is not cached
+//but lies on cached path to the same goal, the rest of that path is returned.
+class PathCache
+{
+	using Key = std::uint64_t;
+	struct Entry
+	{
+		Key key;
+		Path path;
+	};
+	using Entries = std::list<Entry>;
+
+	//Most recently used first
+	Entries entries;
+	std::unordered_map<Key, Entries::iterator> byKey;
+	std::unordered_multimap<GridCSR::Index, Entries::iterator> byGoal;
+	size_t capacity;
+	size_t hits = 0u;
+	size_t suffixHits = 0u;
+	size_t misses = 0u;
+
+	static Key MakeKey(GridCSR::Index begin, GridCSR::Index end);
+	void Evict();
+public:
+	explicit PathCache(size_t capacity = 256u);
+
+	//Empty path on miss
+	Path Find(GridVertex* begin, GridVertex* end);
+	//Lazy and empty paths are not cached
+	void Insert(GridVertex* begin, GridVertex* end, const Path& path);
+	void Clear();
+
+	void SetCapacity(size_t capacity);
+	size_t Capacity() const;
+	size_t Size() const;
+	//Include suffix hits
+	size_t Hits() const;
+	size_t SuffixHits() const;
+	size_t Misses() const;
+};
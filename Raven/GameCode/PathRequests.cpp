@@ -0,0 +1,178 @@
+#include "PathRequests.hpp"
+
+#include "RavenScene.hpp"
+#include "RavenBot.hpp"
+
+PathRequestQueue::PathRequestQueue(RavenGameState* gs, size_t budget): gs(gs), budget(budget)
+{}
+
+PathHandle PathRequestQueue::Submit(RavenBot& bot, GridVertex* begin, GridVertex* end)
+{
+	if(++this->last == NoPathRequest)
+		++this->last;
+	this->requests.push_back(Request{this->last, &bot, begin, end, this->gs->planner, false});
+	bot.SetPathRequest(this->last);
+	return this->last;
+}
+
+CTL::SearchStatus PathRequestQueue::Advance(Request& request, size_t& budget, Path& path)
+{
+	const GridCSR::Index begin = GridCSR::Index(request.begin->Index()), end = GridCSR::Index(request.end->Index());
+	switch(request.planner)
+	{
+	case Planner::Hierarchical:
+	{
+		//Abstract graph is small and refinement is already spread along the path, so it is answered whole
+		path = this->gs->hpa.FindPath(begin, end, this->context);
+		if(!path.Empty()) return CTL::SearchStatus::Found;
+		request.planner = Planner::AStar;
+		return this->Advance(request, budget, path);
+	}
+	case Planner::JumpPoint:
+	{
+		const JumpPointSearch& jps = this->gs->jps;
+		const JumpPointSearch::Index from = jps.CellIndex(request.begin->Label().position);
+		const JumpPointSearch::Index to = jps.CellIndex(request.end->Label().position);
+		if(!request.started)
+			request.started = jps.SearchBegin(from, to, this->context);
+		if(request.started)
+		{
+			const CTL::SearchStatus status = jps.SearchResume(to, this->context, budget);
+			if(status == CTL::SearchStatus::Searching) return status;
+			if(status == CTL::SearchStatus::Found && jps.SearchPath(from, to, this->context, this->indices))
+			{
+				path = this->gs->CellPath(this->indices);
+				return status;
+			}
+		}
+		//Same fallback as RavenGameState::GetPath
+		request.planner = Planner::AStar;
+		request.started = false;
+		return this->Advance(request, budget, path);
+	}
+	default:
+	{
+		const GridCSR& navgraph = this->gs->navgraph;
+		if(!request.started)
+		{
+			navgraph.AStarBegin(begin, end, DiagonalDistance(), this->context);
+			request.started = true;
+		}
+		const CTL::SearchStatus status = navgraph.AStarResume(end, DiagonalDistance(), this->context, budget);
+		if(status == CTL::SearchStatus::Found)
+		{
+			this->context.Unwind(begin, end, this->indices);
+			path = this->gs->NavgraphPath(this->indices);
+		}
+		return status;
+	}
+	}
+}
+
+void PathRequestQueue::Update()
+{
+	size_t budget = this->budget;
+	Path path;
+	while(!this->requests.empty())
+	{
+		Request& request = this->requests.front();
+		if(request.bot->PathRequest() != request.handle)
+		{
+			this->requests.pop_front();
+			continue;
+		}
+		const CTL::SearchStatus status = this->Advance(request, budget, path);
+		if(status == CTL::SearchStatus::Searching) break;
+		if(status == CTL::SearchStatus::Found)
+		{
+			this->gs->pathCache.Insert(request.begin, request.end, path);
+			request.bot->getSteering()->NewPath(std::move(path));
+		}
+		request.bot->SetPathRequest(NoPathRequest);
+		this->requests.pop_front();
+	}
+}
+
+void PathRequestQueue::SetBudget(size_t budget)
+{
+	this->budget = budget;
+}
+
+size_t PathRequestQueue::Budget() const
+{
+	return this->budget;
+}
+
+size_t PathRequestQueue::Pending() const
+{
+	return this->requests.size();
+}
+
+Path NavigationSnapshot::FindPath(GridCSR::Index begin, GridCSR::Index end, GridSearch& context, std::vector<GridCSR::Index>& indices) const
+{
+	std::vector<b2Vec2> waypoints;
+	if(this->planner == Planner::JumpPoint
+	   && this->jps.Search(this->jps.CellIndex(this->navgraph.Label(begin).position), this->jps.CellIndex(this->navgraph.Label(end).position), context, indices))
+	{
+		waypoints.reserve(indices.size());
+		for(JumpPointSearch::Index cell : indices)
+		{
+			waypoints.push_back(this->jps.CellCentre(cell));
+		}
+		return Path(std::move(waypoints));
+	}
+	if(!this->navgraph.AStar(begin, end, DiagonalDistance(), context, indices))
+		return Path();
+	waypoints.reserve(indices.size());
+	for(GridCSR::Index v : indices)
+	{
+		waypoints.push_back(this->navgraph.Label(v).position);
+	}
+	return Path(std::move(waypoints));
+}
+
+AsyncPathPlanner::AsyncPathPlanner(RavenGameState* gs, unsigned threads)
+	: gs(gs), snapshot(std::make_shared<const NavigationSnapshot>(NavigationSnapshot{gs->navgraph, gs->jps, gs->planner})), pool(threads)
+{}
+
+PathHandle AsyncPathPlanner::Submit(RavenBot& bot, GridVertex* begin, GridVertex* end)
+{
+	if(++this->last == NoPathRequest)
+		++this->last;
+	const PathHandle handle = this->last;
+	bot.SetPathRequest(handle);
+	++this->pending;
+	const GridCSR::Index from = GridCSR::Index(begin->Index()), to = GridCSR::Index(end->Index());
+	RavenBot* owner = &bot;
+	std::shared_ptr<const NavigationSnapshot> snapshot = this->snapshot;
+	MPSCQueue<Completion>* completed = &this->completed;
+	this->pool.Enqueue([handle, owner, begin, end, from, to, snapshot, completed]
+	{
+		thread_local GridSearch context;
+		thread_local std::vector<GridCSR::Index> indices;
+		Path path = snapshot->FindPath(from, to, context, indices);
+		const bool found = !path.Empty() || from == to;
+		completed->Push(Completion{handle, owner, begin, end, found, std::move(path)});
+	});
+	return handle;
+}
+
+void AsyncPathPlanner::Update()
+{
+	PathCache& cache = this->gs->pathCache;
+	this->pending -= this->completed.Drain([&cache](Completion& completion)
+	{
+		//Paths are cached even when bot no longer waits for them
+		if(completion.found)
+			cache.Insert(completion.begin, completion.end, completion.path);
+		if(completion.bot->PathRequest() != completion.handle) return;
+		if(completion.found)
+			completion.bot->getSteering()->NewPath(std::move(completion.path));
+		completion.bot->SetPathRequest(NoPathRequest);
+	});
+}
+
+size_t AsyncPathPlanner::Pending() const
+{
+	return this->pending;
+}
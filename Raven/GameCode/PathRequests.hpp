@@ -0,0 +1,100 @@
+#pragma once
+#include <deque>
+#include <vector>
+#include <memory>
+#include "GridGraph.hpp"
+#include "JumpPointSearch.hpp"
+#include "Path.hpp"
+#include "ThreadPool.hpp"
+#include "MPSCQueue.hpp"
+
+class RavenBot;
+class RavenGameState;
+
+//Answers bot path requests. Submit stores handle in the bot, finished path is given to the bot
+//only while it still holds that handle (see RavenBot::setState).
+class PathService
+{
+public:
+	virtual ~PathService() = default;
+	//Replaces request bot was waiting for, bot keeps its current path until the new one arrives
+	virtual PathHandle Submit(RavenBot& bot, GridVertex* begin, GridVertex* end) = 0;
+	//Called every tick on simulation thread
+	virtual void Update() = 0;
+	virtual size_t Pending() const = 0;
+};
+
+//Path requests answered over several ticks. Searches run one at a time in submission order and
+//are advanced under per tick budget of vertex expansions.
+class PathRequestQueue: public PathService
+{
+	struct Request
+	{
+		PathHandle handle;
+		RavenBot* bot;
+		GridVertex* begin;
+		GridVertex* end;
+		Planner planner;
+		bool started;
+	};
+
+	RavenGameState* gs;
+	GridSearch context;
+	std::deque<Request> requests;
+	std::vector<GridCSR::Index> indices;
+	PathHandle last = NoPathRequest;
+	size_t budget;
+
+	CTL::SearchStatus Advance(Request& request, size_t& budget, Path& path);
+public:
+	explicit PathRequestQueue(RavenGameState* gs, size_t budget = 1000u);
+
+	PathHandle Submit(RavenBot& bot, GridVertex* begin, GridVertex* end) override;
+	//Requests abandoned by their bots are dropped before they are searched
+	void Update() override;
+	size_t Pending() const override;
+
+	void SetBudget(size_t budget);
+	size_t Budget() const;
+};
+
+//Navigation data copied once after level generation, never changed, shared by worker threads
+struct NavigationSnapshot
+{
+	GridCSR navgraph;
+	JumpPointSearch jps;
+	Planner planner;
+
+	//Same planners as RavenGameState::GetPath, except Hierarchical which runs as A*
+	Path FindPath(GridCSR::Index begin, GridCSR::Index end, GridSearch& context, std::vector<GridCSR::Index>& indices) const;
+};
+
+//Path requests searched on worker threads against NavigationSnapshot, with per thread search state.
+//Finished paths come back through lock-free queue drained by Update.
+class AsyncPathPlanner: public PathService
+{
+	struct Completion
+	{
+		PathHandle handle;
+		RavenBot* bot;
+		GridVertex* begin;
+		GridVertex* end;
+		bool found;
+		Path path;
+	};
+
+	RavenGameState* gs;
+	std::shared_ptr<const NavigationSnapshot> snapshot;
+	MPSCQueue<Completion> completed;
+	PathHandle last = NoPathRequest;
+	size_t pending = 0u;
+	//Declared last, so workers are joined before the queue they push to is destroyed
+	ThreadPool pool;
+public:
+	AsyncPathPlanner(RavenGameState* gs, unsigned threads);
+
+	PathHandle Submit(RavenBot& bot, GridVertex* begin, GridVertex* end) override;
+	//Hands out paths finished since last call
+	void Update() override;
+	size_t Pending() const override;
+};
@@ -0,0 +1,288 @@
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+#include "PotentiallyVisibleSet.hpp"
+
+namespace
+{
+	constexpr std::uint64_t Magic = 0x31535650u; //"PVS1"
+
+	struct Box
+	{
+		b2Vec2 corners[4];
+	};
+
+	//Edges of one owner. Rays through a convex quad obstacle cross one of its edges, so its diagonals block
+	//as well, unless both cells overlap the quad and the segment may stay inside it
+	struct Blocker
+	{
+		std::vector<Edge> edges;
+		std::vector<Edge> diagonals;
+		std::vector<bool> overlaps;
+	};
+
+	Box CellBox(size_t cell, size_t width, float margin)
+	{
+		const float x = float(cell % width), y = float(cell / width);
+		return Box{{{x - margin, y - margin}, {x + 1.f + margin, y - margin},
+					{x + 1.f + margin, y + 1.f + margin}, {x - margin, y + 1.f + margin}}};
+	}
+
+	//Every segment between the boxes crosses edge away from its ends. Segments between convex sets cross the
+	//edge line in an interval spanned by corner to corner segments, so testing those is enough
+	bool Separates(const Edge& edge, const Box& a, const Box& b)
+	{
+		constexpr float end = 1e-3f;
+		const b2Vec2 c = edge.From(), cd = edge.To() - edge.From();
+		for(b2Vec2 p : a.corners)
+		{
+			for(b2Vec2 q : b.corners)
+			{
+				const b2Vec2 pq = q - p, pc = c - p;
+				const float det = b2Cross(pq, cd);
+				if(det == 0.f) return false;
+				const float s = b2Cross(pc, cd) / det, t = b2Cross(pc, pq) / det;
+				if(s <= 0.f || s >= 1.f || t <= end || t >= 1.f - end) return false;
+			}
+		}
+		return true;
+	}
+
+	//Separating axis test of a box against a convex polygon
+	bool Overlaps(const Box& box, const std::vector<b2Vec2>& polygon)
+	{
+		std::vector<b2Vec2> axes{{1.f, 0.f}, {0.f, 1.f}};
+		for(size_t i = 0u; i < polygon.size(); ++i)
+		{
+			axes.push_back((polygon[(i + 1u) % polygon.size()] - polygon[i]).Skew());
+		}
+		for(b2Vec2 axis : axes)
+		{
+			float lowA = b2Dot(axis, box.corners[0]), highA = lowA;
+			for(b2Vec2 p : box.corners)
+			{
+				lowA = std::min(lowA, b2Dot(axis, p));
+				highA = std::max(highA, b2Dot(axis, p));
+			}
+			float lowB = b2Dot(axis, polygon[0]), highB = lowB;
+			for(b2Vec2 p : polygon)
+			{
+				lowB = std::min(lowB, b2Dot(axis, p));
+				highB = std::max(highB, b2Dot(axis, p));
+			}
+			if(highA < lowB || highB < lowA) return false;
+		}
+		return true;
+	}
+
+	//Corners of a quad in order around its centre, empty when edges do not form a convex quad
+	std::vector<b2Vec2> ConvexQuad(const std::vector<Edge>& edges)
+	{
+		if(edges.size() != 4u) return {};
+		std::vector<b2Vec2> corners;
+		b2Vec2 centre = b2Vec2_zero;
+		for(const Edge& edge : edges)
+		{
+			corners.push_back(edge.From());
+			centre += 0.25f * edge.From();
+		}
+		std::sort(corners.begin(), corners.end(), [centre](b2Vec2 a, b2Vec2 b)
+		{
+			return b2Atan2(a.y - centre.y, a.x - centre.x) < b2Atan2(b.y - centre.y, b.x - centre.x);
+		});
+		for(size_t i = 0u; i < 4u; ++i)
+		{
+			const b2Vec2 a = corners[i], b = corners[(i + 1u) % 4u], c = corners[(i + 2u) % 4u];
+			if(b2Cross(b - a, c - b) <= 0.f) return {};
+		}
+		return corners;
+	}
+}
+
+std::uint64_t PotentiallyVisibleSet::Key(const EdgeTree& edges, size_t width, size_t height, float margin)
+{
+	//FNV-1a of every value, edges are summed so their order does not matter
+	auto hash = [](std::initializer_list<float> values)
+	{
+		std::uint64_t h = 0xcbf29ce484222325u;
+		for(float value : values)
+		{
+			std::uint32_t word;
+			static_assert(sizeof(word) == sizeof(value), "float has to be 32 bit");
+			std::copy_n(reinterpret_cast<const char*>(&value), sizeof(value), reinterpret_cast<char*>(&word));
+			for(size_t i = 0u; i < sizeof(word); ++i)
+			{
+				h = (h ^ ((word >> (8u * i)) & 0xffu)) * 0x100000001b3u;
+			}
+		}
+		return h;
+	};
+	std::uint64_t key = hash({float(width), float(height), margin});
+	for(size_t i = 0u; i < edges.Size(); ++i)
+	{
+		const Wall& edge = edges[i].edge;
+		key += hash({edge.From().x, edge.From().y, edge.To().x, edge.To().y});
+	}
+	return key;
+}
+
+void PotentiallyVisibleSet::Build(const EdgeTree& edges, size_t width, size_t height, float margin, ThreadPool& pool)
+{
+	this->width = width;
+	this->height = height;
+	const size_t cells = width * height;
+	this->words = (cells + 63u) / 64u;
+	this->bits.assign(cells * this->words, 0u);
+
+	std::vector<Blocker> blockers;
+	std::vector<size_t> blockerOf(edges.Size());
+	std::vector<const SGE::Object*> owners;
+	for(size_t i = 0u; i < edges.Size(); ++i)
+	{
+		const size_t owner = size_t(std::find(owners.begin(), owners.end(), edges[i].owner) - owners.begin());
+		if(owner == owners.size())
+		{
+			owners.push_back(edges[i].owner);
+			blockers.emplace_back();
+		}
+		blockers[owner].edges.push_back(edges[i].edge);
+		blockerOf[i] = owner;
+	}
+	for(size_t owner = 0u; owner < blockers.size(); ++owner)
+	{
+		Blocker& blocker = blockers[owner];
+		const std::vector<b2Vec2> quad = ConvexQuad(blocker.edges);
+		if(quad.empty() || blocker.edges.size() != 4u) continue;
+		blocker.diagonals = {Edge(quad[0], quad[2]), Edge(quad[1], quad[3])};
+		blocker.overlaps.resize(cells);
+		for(size_t cell = 0u; cell < cells; ++cell)
+		{
+			blocker.overlaps[cell] = Overlaps(CellBox(cell, width, margin), quad);
+		}
+	}
+	auto blocks = [&blockers, width, margin](size_t owner, size_t a, size_t b)
+	{
+		const Blocker& blocker = blockers[owner];
+		const Box boxA = CellBox(a, width, margin), boxB = CellBox(b, width, margin);
+		for(const Edge& edge : blocker.edges)
+		{
+			if(Separates(edge, boxA, boxB)) return true;
+		}
+		if(blocker.diagonals.empty() || (blocker.overlaps[a] && blocker.overlaps[b])) return false;
+		for(const Edge& edge : blocker.diagonals)
+		{
+			if(Separates(edge, boxA, boxB)) return true;
+		}
+		return false;
+	};
+	//Every blocker crosses the segment between cell centres, so only owners of the first and last edges it hits
+	//are tried, after the one which hid the previous cell of the row
+	auto hidden = [&](size_t a, size_t b, size_t& previous)
+	{
+		if(previous < blockers.size() && blocks(previous, a, b)) return true;
+		const b2Vec2 centreA{0.5f + a % width, 0.5f + a / width}, centreB{0.5f + b % width, 0.5f + b / width};
+		float distance;
+		b2Vec2 point;
+		const EdgeTree::Entry* first;
+		const EdgeTree::Entry* last;
+		if(!edges.Raycast(centreA, centreB, distance, point, first)) return false;
+		const size_t owner = blockerOf[size_t(first - &edges[0])];
+		if(owner != previous && blocks(owner, a, b))
+		{
+			previous = owner;
+			return true;
+		}
+		if(!edges.Raycast(centreB, centreA, distance, point, last)) return false;
+		const size_t other = blockerOf[size_t(last - &edges[0])];
+		if(other == owner || other == previous || !blocks(other, a, b)) return false;
+		previous = other;
+		return true;
+	};
+
+	const size_t chunks = pool.Size() + 1u;
+	pool.ParallelFor(chunks, [&](size_t chunk, size_t, size_t)
+	{
+		//Rows get shorter, so they are dealt out in turn
+		for(size_t a = chunk; a < cells; a += chunks)
+		{
+			this->Set(a, a);
+			size_t previous = blockers.size();
+			for(size_t b = a + 1u; b < cells; ++b)
+			{
+				if(!hidden(a, b, previous)) this->Set(a, b);
+			}
+		}
+	});
+	for(size_t a = 0u; a < cells; ++a)
+	{
+		for(size_t b = a + 1u; b < cells; ++b)
+		{
+			if(this->Visible(a, b)) this->Set(b, a);
+		}
+	}
+}
+
+bool PotentiallyVisibleSet::Load(const std::string& path, std::uint64_t key)
+{
+	std::ifstream file(path, std::ios::binary);
+	std::uint64_t header[4];
+	if(!file.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+	if(header[0] != Magic || header[1] != key) return false;
+	const size_t cells = size_t(header[2] * header[3]);
+	std::vector<std::uint64_t> bits(cells * ((cells + 63u) / 64u));
+	if(!file.read(reinterpret_cast<char*>(bits.data()), std::streamsize(bits.size() * sizeof(std::uint64_t)))) return false;
+	this->width = size_t(header[2]);
+	this->height = size_t(header[3]);
+	this->words = (cells + 63u) / 64u;
+	this->bits = std::move(bits);
+	return true;
+}
+
+bool PotentiallyVisibleSet::Save(const std::string& path, std::uint64_t key) const
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	const std::uint64_t header[4] = {Magic, key, this->width, this->height};
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(this->bits.data()), std::streamsize(this->bits.size() * sizeof(std::uint64_t)));
+	return bool(file);
+}
+
+void PotentiallyVisibleSet::Clear()
+{
+	this->width = this->height = this->words = 0u;
+	this->bits.clear();
+}
+
+bool PotentiallyVisibleSet::Empty() const
+{
+	return this->bits.empty();
+}
+
+size_t PotentiallyVisibleSet::Cells() const
+{
+	return this->width * this->height;
+}
+
+void PotentiallyVisibleSet::Set(size_t from, size_t to)
+{
+	this->bits[from * this->words + to / 64u] |= std::uint64_t(1u) << (to % 64u);
+}
+
+size_t PotentiallyVisibleSet::Index(b2Vec2 pos) const
+{
+	const int x = std::min(std::max(int(std::floor(pos.x)), 0), int(this->width) - 1);
+	const int y = std::min(std::max(int(std::floor(pos.y)), 0), int(this->height) - 1);
+	return size_t(y) * this->width + size_t(x);
+}
+
+bool PotentiallyVisibleSet::Visible(size_t from, size_t to) const
+{
+	if(this->bits.empty()) return true;
+	return (this->bits[from * this->words + to / 64u] >> (to % 64u)) & 1u;
+}
+
+bool PotentiallyVisibleSet::Visible(b2Vec2 from, b2Vec2 to) const
+{
+	if(this->bits.empty()) return true;
+	return this->Visible(this->Index(from), this->Index(to));
+}
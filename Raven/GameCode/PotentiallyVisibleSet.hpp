@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "EdgeTree.hpp"
+#include "ThreadPool.hpp"
+
+//Potentially visible set of unit grid cells, one bit per pair of cells. A clear bit means that no segment between
+//points of the two cells, each grown by margin, gets past the static edges, a set bit only that it may. Walls and
+//obstacles do not move once the level is generated, so the table is built once and may be kept on disk.
+class PotentiallyVisibleSet
+{
+	size_t width = 0u, height = 0u;
+	//64 bit words per row, row per cell
+	size_t words = 0u;
+	std::vector<std::uint64_t> bits;
+
+	size_t Index(b2Vec2 pos) const;
+	void Set(size_t from, size_t to);
+public:
+	//Hash of everything the table depends on, tables are saved and loaded under it
+	static std::uint64_t Key(const EdgeTree& edges, size_t width, size_t height, float margin);
+
+	void Build(const EdgeTree& edges, size_t width, size_t height, float margin, ThreadPool& pool);
+	bool Load(const std::string& path, std::uint64_t key);
+	bool Save(const std::string& path, std::uint64_t key) const;
+	void Clear();
+
+	bool Empty() const;
+	size_t Cells() const;
+	//Always true for an empty table. Positions outside the grid use its border cells
+	bool Visible(size_t from, size_t to) const;
+	bool Visible(b2Vec2 from, b2Vec2 to) const;
+};
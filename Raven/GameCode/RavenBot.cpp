@@ -1,2 +1,9 @@
 #include "RavenBot.hpp"
 #include "SteeringBehaviours.hpp"
+#include "World.hpp"
+
+void RavenBot::setPosition(b2Vec2 position)
+{
+	SGE::Object::setPosition(position);
+	if(this->world) this->world->UpdateMover(this);
+}
@@ -46,6 +46,11 @@ protected:
 	World* world = nullptr;
 	SteeringBehaviours* steering = new RavenSteering(this);
 	BotState state = BotState::Wandering;
+	PathHandle pathRequest = NoPathRequest;
+	//Where World's movers partition holds the bot until next World::SyncMovers
+	b2Vec2 partitionPosition = b2Vec2_zero;
+	bool partitionMoved = false;
+	friend class World;
 public:
 	std::set<RavenBot*> enemies;
 	std::set<Item*> items;
@@ -139,6 +144,9 @@ public:
 		return world;
 	}
 
+	//Hides SGE::Object::setPosition, so that World learns of every move of the bot
+	void setPosition(b2Vec2 position);
+
 	SteeringBehaviours* getSteering() const
 	{
 		return steering;
@@ -172,8 +180,24 @@ public:
 	void setState(BotState state)
 	{
 		this->steering->ClearPath();
+		this->pathRequest = NoPathRequest;
 		this->state = state;
 	}
+
+	PathHandle PathRequest() const
+	{
+		return this->pathRequest;
+	}
+
+	void SetPathRequest(PathHandle handle)
+	{
+		this->pathRequest = handle;
+	}
+
+	bool IsWaitingForPath() const
+	{
+		return this->pathRequest != NoPathRequest;
+	}
 	
 	float Health() const
 	{
@@ -5,6 +5,8 @@
 #include <Object/Shape/sge_shape.hpp>
 #include <algorithm>
 #include <random>
+#include <thread>
+#include <sstream>
 
 #include "RavenScene.hpp"
 #include "Image.hpp"
@@ -16,23 +18,12 @@
 #include "Game/InputHandler/sge_input_binder.hpp"
 #include "Renderer/SpriteBatch/sge_sprite_batch.hpp"
 #include "Renderer/sge_renderer.hpp"
-#include <allocators>
 #include "QuadBatch.hpp"
 #include "QuadObject.hpp"
 #include <queue>
 #include "Graph.hpp"
 #include "Actions.hpp"
 
-class RGTrace: public SGE::Object
-{
-public:
-	RGTrace(): Object(b2Vec2_zero, true)
-	{
-		this->Object::setVisible(false);
-	}
-	~RGTrace() = default;
-};
-
 class Distance
 {
 public:
@@ -42,23 +33,20 @@ public:
 	}
 };
 
-class DiagonalDistance
-{
-	const static float sqrt2;
-public:
-	float operator()(const GridVertex* cur, const GridVertex* end) const
-	{
-		auto node = cur->Label().position, goal = end->Label().position;
-		float dx = abs(node.x - goal.x), dy = abs(node.y - goal.y);
-		return dx < dy ? dx * sqrt2 + dy - dx : dy * sqrt2 + dx - dy;
-	}
-};
-const float DiagonalDistance::sqrt2 = sqrt(2.f);
-
 
 void RavenGameState::InitRandomEngine()
 {
-	this->rand = std::bind(std::uniform_int_distribution<size_t>(0, graph.VertexCount()-1u), std::default_random_engine{});
+	this->rand = std::bind(std::uniform_int_distribution<size_t>(0, graph.VertexCount()-1u), std::default_random_engine{this->seed});
+	//Another stream than vertex picks, which seed + 1 would give to the next headless match
+	std::seed_seq wanderSeed{this->seed, 1u};
+	this->wanderEngine.seed(wanderSeed);
+}
+
+ThreadPool& RavenGameState::SimulationPool()
+{
+	if(!this->simulationPool)
+		this->simulationPool.reset(new ThreadPool(this->simulationThreads));
+	return *this->simulationPool;
 }
 
 GridCell* RavenGameState::GetCell(b2Vec2 pos)
@@ -113,10 +101,67 @@ GridVertex* RavenGameState::GetRandomVertex(const b2Vec2& position, const float
 	return res;
 }
 
+GridVertex* RavenGameState::GetCoverVertex(const b2Vec2& threat, const float limit)
+{
+	constexpr size_t attempts = 32u;
+	GridVertex* res = this->GetRandomVertex(threat, limit, false);
+	for(size_t i = 1u; i < attempts && this->pvs.Visible(threat, res->Label().position); ++i)
+	{
+		res = this->GetRandomVertex(threat, limit, false);
+	}
+	return res;
+}
+
 Path RavenGameState::GetPath(GridVertex * begin, GridVertex * end)
 {
-	this->graph.AStar(begin, end, DiagonalDistance());
-	return Path(begin, end);
+	Path path = this->pathCache.Find(begin, end);
+	if(!path.Empty())
+		return path;
+	path = this->PlanPath(begin, end);
+	this->pathCache.Insert(begin, end, path);
+	return path;
+}
+
+Path RavenGameState::PlanPath(GridVertex * begin, GridVertex * end)
+{
+	std::vector<GridCSR::Index> indices;
+	if(this->planner == Planner::Hierarchical)
+	{
+		Path path = this->hpa.FindPath(GridCSR::Index(begin->Index()), GridCSR::Index(end->Index()), this->search);
+		if(!path.Empty())
+			return path;
+	}
+	//Jump Point Search skips cells next to clipped corners, A* covers those
+	if(this->planner == Planner::JumpPoint
+	   && this->jps.Search(this->jps.CellIndex(begin->Label().position), this->jps.CellIndex(end->Label().position), this->search, indices))
+	{
+		return this->CellPath(indices);
+	}
+	if(!this->navgraph.AStar(GridCSR::Index(begin->Index()), GridCSR::Index(end->Index()), DiagonalDistance(), this->search, indices))
+		return Path();
+	return this->NavgraphPath(indices);
+}
+
+Path RavenGameState::NavgraphPath(const std::vector<GridCSR::Index>& vertices) const
+{
+	std::vector<b2Vec2> waypoints;
+	waypoints.reserve(vertices.size());
+	for(GridCSR::Index v : vertices)
+	{
+		waypoints.push_back(this->navgraph.Label(v).position);
+	}
+	return Path(std::move(waypoints));
+}
+
+Path RavenGameState::CellPath(const std::vector<JumpPointSearch::Index>& cells) const
+{
+	std::vector<b2Vec2> waypoints;
+	waypoints.reserve(cells.size());
+	for(JumpPointSearch::Index cell : cells)
+	{
+		waypoints.push_back(this->jps.CellCentre(cell));
+	}
+	return Path(std::move(waypoints));
 }
 
 void RavenGameState::UseItem(Item* item)
@@ -133,7 +178,7 @@ void RavenGameState::NewRocket(b2Vec2 pos, b2Vec2 direction)
 	direction.Normalize();
 	Rocket* rocket = new Rocket(pos + 0.5f * direction, direction);
 	this->world->AddRocket(rocket);
-	this->rocketBatch->addObject(rocket);
+	if(this->rocketBatch) this->rocketBatch->addObject(rocket);
 	this->rockets.push_back(rocket);
 }
 
@@ -141,7 +186,7 @@ void RavenGameState::AddExplosion(Rocket* rocket)
 {
 	rocket->setShape(Rocket::ExplosionShape());
 	rocket->setLayer(-0.6);
-	this->explosionBatch->addObject(rocket);
+	if(this->explosionBatch) this->explosionBatch->addObject(rocket);
 	this->explosions.push_back(rocket);
 }
 
@@ -149,14 +194,14 @@ void RavenGameState::AddExplosion(Rocket* rocket)
 void RavenGameState::RemoveRocket(Rocket* rocket)
 {
 	this->world->RemoveRocket(rocket);
-	this->rocketBatch->removeObject(rocket);
+	if(this->rocketBatch) this->rocketBatch->removeObject(rocket);
 	this->rockets.erase(std::find(this->rockets.begin(), this->rockets.end(), rocket));
 	this->AddExplosion(rocket);
 }
 
 void RavenGameState::RemoveExplosion(Rocket* rocket)
 {
-	this->explosionBatch->removeObject(rocket);
+	if(this->explosionBatch) this->explosionBatch->removeObject(rocket);
 	this->explosions.erase(std::find(this->explosions.begin(), this->explosions.end(), rocket));
 	delete rocket;
 }
@@ -167,7 +212,7 @@ void RavenGameState::GenerateItems(const size_t bots, SGE::RealSpriteBatch* batc
 	for(size_t i = 0u; i < bots; ++i)
 	{
 		Item* item = new T(this->GetRandomVertex()->Label().position);
-		batch->addObject(item);
+		if(batch) batch->addObject(item);
 		this->items.push_back(item);
 	}
 }
@@ -188,6 +233,12 @@ path([game](const char* path)
 	static bool initialized = init();
 }
 
+void RavenScene::FixSeed(unsigned seed)
+{
+	this->seed = seed;
+	this->fixedSeed = true;
+}
+
 struct GridCellBuild
 {
 	size_t x = 0u, y = 0u;
@@ -231,12 +282,281 @@ public:
 	{}
 };
 
-constexpr size_t Bots = 5u;
+void RavenGameState::GenerateObstacles(QuadBatch* batch)
+{
+	using Quad = QuadBatch::Quad;
+	std::uniform_real_distribution<float> angle_distribution(-b2_pi, b2_pi);
+	std::mt19937 engine(this->seed);
+	auto angle = std::bind(angle_distribution, engine);
+	constexpr float RB1 = 24.f; //Region Boundary
+	constexpr float RB2 = 10.f; //Region Boundary
+	Quad Diamond1 = {64.f * glm::vec2{-20.f, 0.f}, 64.f * glm::vec2{0, -8.f}, 64.f * glm::vec2{20.f, 0.f}, 64.f * glm::vec2{0.f, 8.f } };
+	Quad Diamond2 = {64.f * glm::vec2{-8.f, 0.f}, 64.f * glm::vec2{0, -3.f}, 64.f * glm::vec2{8.f, 0.f}, 64.f * glm::vec2{0.f, 3.f}};
+	SGE::Object* obstacle1  = new QuadObstacle(RB1,         RB1,          angle(), Diamond1);
+	SGE::Object* obstacle2  = new QuadObstacle(Width - RB1, RB1,          angle(), Diamond1);
+	SGE::Object* obstacle3  = new QuadObstacle(Width - RB1, Height - RB1, angle(), Diamond1);
+	SGE::Object* obstacle4  = new QuadObstacle(RB1,         Height - RB1, angle(), Diamond1);
+	SGE::Object* obstacle5  = new QuadObstacle(RB2,         RB2,          angle(), Diamond2);
+	SGE::Object* obstacle6  = new QuadObstacle(Width - RB2, RB2,          angle(), Diamond2);
+	SGE::Object* obstacle7  = new QuadObstacle(Width - RB2, Height - RB2, angle(), Diamond2);
+	SGE::Object* obstacle8  = new QuadObstacle(RB2,         Height - RB2, angle(), Diamond2);
+	SGE::Object* obstacle9  = new QuadObstacle(RB2,         .5f * Height, angle(), Diamond2);
+	SGE::Object* obstacle10 = new QuadObstacle(.5f * Width, RB2,          angle(), Diamond2);
+	SGE::Object* obstacle11 = new QuadObstacle(Width - RB2, .5f * Height, angle(), Diamond2);
+	SGE::Object* obstacle12 = new QuadObstacle(.5f * Width, Height - RB2, angle(), Diamond2);
+
+	for(auto ob : {obstacle1, obstacle2, obstacle3, obstacle4})
+	{
+		if(batch) batch->addObject(ob, Diamond1);
+		this->world->AddObstacle(ob);
+		this->obstacles.push_back(ob);
+	}
+
+	for(auto ob : {obstacle5, obstacle6, obstacle7, obstacle8, obstacle9, obstacle10, obstacle11, obstacle12})
+	{
+		if(batch) batch->addObject(ob, Diamond2);
+		this->world->AddObstacle(ob);
+		this->obstacles.push_back(ob);
+	}
+}
+
+//#define GraphCellDebug
+#define GraphEdgeDebug
+void RavenGameState::GenerateGraph(SGE::RealSpriteBatch* graphTestBatch, SGE::RealSpriteBatch* graphEdgeTestBatch)
+{
+	std::queue<GridCellBuild*> cells;
+	int intersections = 0;
+	GridCellBuild grid[Y][X];
+	std::pair<int, int> directions[8] =
+	{
+		{-1, -1}, {-1, 0}, {-1, 1}, {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}
+	};
+	b2Vec2 points[4] = {{-.5f, 0.f}, {0.f, -.5f}, {0.5f, 0.f}, {0.f, .5f}};
+	b2Vec2 diags[4];
+	for(size_t i = 0; i < 4u; ++i)
+		diags[i] = b2Mul(b2Rot(0.5f * b2_pi), points[i]);
+
+	for(size_t x = 0u; x < X; ++x)
+		for(size_t y = 0u; y < Y; ++y)
+		{
+			grid[y][x].x = x;
+			grid[y][x].y = y;
+		}
+
+	grid[0][0].state = GridCellBuild::Queued;
+	cells.push(&grid[0][0]);
+
+	std::vector<SGE::Object*> obstacles;
+	while(!cells.empty())
+	{
+		GridCellBuild& currentCell = *cells.front();
+		cells.pop();
+		intersections = 0;
+		b2Vec2 pos = b2Vec2{0.5f + currentCell.x, 0.5f + currentCell.y};
+		this->world->getObstacles(obstacles, pos, 1.5f);
+		for(SGE::Object* o : obstacles)
+		{
+			QuadObstacle* qo = dynamic_cast<QuadObstacle*>(o);
+			if(!qo) continue;
+			for(Edge edge : qo->getEdges())
+			{
+				b2Vec2 radius = -edge.Normal();
+				radius *= 0.5f;
+				float dist = b2DistanceSquared(pos, edge.From());
+				if(dist <= 0.25f)
+				{
+					currentCell.state = GridCellBuild::Invalid;
+					break;
+				}
+				b2Vec2 intersection;
+				if(LineIntersection(pos, pos + radius, edge.From(), edge.To(), dist, intersection))
+				{
+					currentCell.state = GridCellBuild::Invalid;
+					break;
+				}
+				if(LineIntersection(pos, pos + b2Vec2{100.f, 0.f}, edge.From(), edge.To(), dist, intersection))
+				{
+					++intersections;
+				}
+			}
+			if(currentCell.state == GridCellBuild::Invalid || 1 == intersections % 2)
+				break;
+		}
+		if(currentCell.state != GridCellBuild::Invalid && 0 == intersections % 2)
+		{
+			currentCell.state = GridCellBuild::Accepted;
+			currentCell.vertex = new GridVertex(CellLabel(pos));
+			this->graph.AddVertex(currentCell.vertex);
+#ifdef GraphCellDebug
+			if(graphTestBatch)
+			{
+				currentCell.dummy = new GraphCellDummy(currentCell.x, currentCell.y);
+				graphTestBatch->addObject(currentCell.dummy);
+			}
+#endif
+			for(size_t i = 0u; i < 8u; ++i)
+			{
+				auto dir = directions[i];
+				size_t x = currentCell.x + dir.first;
+				size_t y = currentCell.y + dir.second;
+				b2Vec2 edgeVec = b2Vec2{float(dir.first), float(dir.second)};
+				if(x < X && y < Y)
+				{
+					GridCellBuild& otherCell = grid[y][x];
+					switch(otherCell.state)
+					{
+					case GridCellBuild::Accepted:
+					{
+						bool intersected = false;
+						for(SGE::Object* o : obstacles)
+						{
+							QuadObstacle* qo = dynamic_cast<QuadObstacle*>(o);
+							if(!qo) continue;
+							for(Edge edge : qo->getEdges())
+							{
+								b2Vec2(&pts)[4] = i % 2 ? diags : points;
+								for(b2Vec2 offset : pts)
+								{
+									b2Vec2 from = pos + offset;
+									b2Vec2 to = from + edgeVec;
+									float dist;
+									b2Vec2 inters;
+									intersected = LineIntersection(from, to, edge.From(), edge.To(), dist, inters);
+									if(intersected)
+									{
+										break;
+									}
+								}
+								if(intersected) break;
+							}
+							if(intersected) break;
+						}
+						if(!intersected)
+						{
+							this->graph.AddEdge(currentCell.vertex, otherCell.vertex, edgeVec.Length());
+#ifdef GraphEdgeDebug
+							if(graphEdgeTestBatch)
+							{
+								auto edgeOb = new GraphEdgeDummy(pos + 0.5f * edgeVec);
+								edgeOb->setOrientation(edgeVec.Orientation());
+								edgeOb->setLayer(.5f);
+								edgeOb->setShape(SGE::Shape::Rectangle(edgeVec.Length(), 0.05f, true));
+								graphEdgeTestBatch->addObject(edgeOb);
+							}
+#endif
+						}
+						break;
+					}
+					case GridCellBuild::Queued: break;
+					case GridCellBuild::Untested:
+					{
+						otherCell.state = GridCellBuild::Queued;
+						cells.push(&otherCell);
+						break;
+					}
+					case GridCellBuild::Invalid: break;
+					default: break;
+					}
+				}
+			}
+		}
+	}
+	for(size_t x = 0u; x < X; ++x)
+	{
+		for(size_t y = 0u; y < Y; ++y)
+		{
+			if(grid[y][x].state == GridCellBuild::Accepted)
+			{
+				auto& cell = this->cells[y][x];
+				cell.state = GridCell::Valid;
+				cell.vertex = grid[y][x].vertex;
+			}
+		}
+	}
+//#define ASTARDEBUG
+#ifdef ASTARDEBUG
+	//Test
+	GridVertex* begin = this->cells[0][0].vertex;
+	GridVertex* end = this->cells[Y-1u][X - 1u].vertex;
+	this->graph.AStar(begin, end, DiagonalDistance{});
+	while(end != begin)
+	{
+		graphTestBatch->addObject(new GraphCellDummy(end->Label().position));
+		end = end->Parent();
+	}
+	for(auto v : this->graph)
+	{
+		if(v->State() != CTL::VertexState::White)
+		{
+			graphTestBatch->addObject(new GraphCellDummy1(v->Label().position));
+		}
+	}
+#endif
+}
+
+void RavenGameState::GenerateVisibility()
+{
+	//Bots and items are circles of this radius, they can be hit through cells next to them
+	const float margin = getCircle()->getRadius();
+	const EdgeTree& edges = this->world->getStaticEdges();
+	const std::uint64_t key = PotentiallyVisibleSet::Key(edges, X, Y, margin);
+	std::string file;
+	if(!this->visibilityCache.empty())
+	{
+		std::ostringstream name;
+		name << this->visibilityCache << "pvs_" << std::hex << key << ".bin";
+		file = name.str();
+		if(this->pvs.Load(file, key)) return;
+	}
+	this->pvs.Build(edges, X, Y, margin, this->SimulationPool());
+	if(!file.empty() && !this->pvs.Save(file, key))
+		std::cerr << "Could not save cell visibility to " << file << std::endl;
+}
+
+void RavenGameState::GenerateBots(const size_t bots, SGE::RealSpriteBatch* batch)
+{
+	this->bots.reserve(bots);
+	for(size_t i = 0u; i < bots; ++i)
+	{
+		this->bots.emplace_back(this->GetRandomVertex()->Label().position, getCircle(), this->world);
+		RavenBot* bot = &this->bots.back();
+		bot->getSteering()->setRandomEngine(&this->wanderEngine);
+		if(batch) batch->addObject(bot);
+		this->world->AddMover(bot);
+		bot->RailgunTrace = new RGTrace();
+		if(this->railBatch) this->railBatch->addObject(bot->RailgunTrace);
+	}
+}
+
+void RavenGameState::GenerateLevel(const size_t bots, const RavenBatches& batches)
+{
+	this->GenerateObstacles(batches.obstacles);
+	this->GenerateGraph(batches.graphCells, batches.graphEdges);
+	this->navgraph.Freeze(this->graph);
+	this->jps.Build(&this->cells[0][0], X, Y);
+	this->hpa.Build(this->navgraph, X, Y);
+	if(this->buildVisibility) this->GenerateVisibility();
+	this->InitRandomEngine();
+	this->GenerateBots(bots, batches.bots);
+	this->GenerateItems<HealthPack>(bots, batches.health);
+	this->GenerateItems<ArmorPack>(bots, batches.armor);
+	this->GenerateItems<RocketAmmo>(bots, batches.rlammo);
+	this->GenerateItems<RailgunAmmo>(bots, batches.rgammo);
+}
 
 void RavenScene::loadScene()
 {
 	this->gs = new RavenGameState();
 	this->gs->world = &this->world;
+	//One core is left to simulation thread
+	this->gs->pathThreads = std::max(std::thread::hardware_concurrency(), 1u) - 1u;
+	this->gs->simulationThreads = this->gs->pathThreads;
+	this->gs->buildVisibility = true;
+	if(this->fixedSeed)
+	{
+		this->gs->seed = this->seed;
+		this->gs->visibilityCache = this->game->getGamePath() + "Levels/";
+	}
 
 	//RenderBatches
 	SGE::BatchRenderer* renderer = SGE::Game::getGame()->getRenderer();
@@ -324,240 +644,31 @@ void RavenScene::loadScene()
 	this->addLogic(new SGE::Logics::CameraZoom(cam, 0.5f, 1.f, 0.197f, SGE::Key::Q, SGE::Key::E));
 	//!Camera
 
-	//Obstacles
-	using Quad = QuadBatch::Quad;
-	std::uniform_real_distribution<float> angle_distribution(-b2_pi, b2_pi);
-	std::mt19937 engine((std::random_device{})());
-	auto angle = std::bind(angle_distribution, engine);
-	constexpr float RB1 = 24.f; //Region Boundary
-	constexpr float RB2 = 10.f; //Region Boundary
-	Quad Diamond1 = {64.f * glm::vec2{-20.f, 0.f}, 64.f * glm::vec2{0, -8.f}, 64.f * glm::vec2{20.f, 0.f}, 64.f * glm::vec2{0.f, 8.f } };
-	Quad Diamond2 = {64.f * glm::vec2{-8.f, 0.f}, 64.f * glm::vec2{0, -3.f}, 64.f * glm::vec2{8.f, 0.f}, 64.f * glm::vec2{0.f, 3.f}};
-	SGE::Object* obstacle1  = new QuadObstacle(RB1,         RB1,          angle(), Diamond1);
-	SGE::Object* obstacle2  = new QuadObstacle(Width - RB1, RB1,          angle(), Diamond1);
-	SGE::Object* obstacle3  = new QuadObstacle(Width - RB1, Height - RB1, angle(), Diamond1);
-	SGE::Object* obstacle4  = new QuadObstacle(RB1,         Height - RB1, angle(), Diamond1);
-	SGE::Object* obstacle5  = new QuadObstacle(RB2,         RB2,          angle(), Diamond2);
-	SGE::Object* obstacle6  = new QuadObstacle(Width - RB2, RB2,          angle(), Diamond2);
-	SGE::Object* obstacle7  = new QuadObstacle(Width - RB2, Height - RB2, angle(), Diamond2);
-	SGE::Object* obstacle8  = new QuadObstacle(RB2,         Height - RB2, angle(), Diamond2);
-	SGE::Object* obstacle9  = new QuadObstacle(RB2,         .5f * Height, angle(), Diamond2);
-	SGE::Object* obstacle10 = new QuadObstacle(.5f * Width, RB2,          angle(), Diamond2);
-	SGE::Object* obstacle11 = new QuadObstacle(Width - RB2, .5f * Height, angle(), Diamond2);
-	SGE::Object* obstacle12 = new QuadObstacle(.5f * Width, Height - RB2, angle(), Diamond2);
-
-	for(auto ob : {obstacle1, obstacle2, obstacle3, obstacle4})
-	{
-		obBatch->addObject(ob, Diamond1);
-		this->world.AddObstacle(ob);
-		this->gs->obstacles.push_back(ob);
-	}
-
-	for(auto ob : {obstacle5, obstacle6, obstacle7, obstacle8, obstacle9, obstacle10, obstacle11, obstacle12})
-	{
-		obBatch->addObject(ob, Diamond2);
-		this->world.AddObstacle(ob);
-		this->gs->obstacles.push_back(ob);
-	}
+	//Level
+	RavenBatches batches;
+	batches.obstacles = obBatch;
+	batches.bots = botBatch;
+	batches.health = healthBatch;
+	batches.armor = armorBatch;
+	batches.rlammo = rlammoBatch;
+	batches.rgammo = rgammoBatch;
+	batches.graphCells = graphTestBatch;
+	batches.graphEdges = graphEdgeTestBatch;
+	this->gs->GenerateLevel(Bots, batches);
+	//!Level
 
-	//Grid
-//#define GraphCellDebug
-#define GraphEdgeDebug
-	{
-		std::queue<GridCellBuild*> cells;
-		int intersections = 0;
-		GridCellBuild grid[Y][X];
-		std::pair<int, int> directions[8] =
-		{
-			{-1, -1}, {-1, 0}, {-1, 1}, {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}
-		};
-		b2Vec2 points[4] = {{-.5f, 0.f}, {0.f, -.5f}, {0.5f, 0.f}, {0.f, .5f}};
-		b2Vec2 diags[4];
-		for(size_t i = 0; i < 4u; ++i)
-			diags[i] = b2Mul(b2Rot(0.5f * b2_pi), points[i]);
-
-		for(size_t x = 0u; x < X; ++x)
-			for(size_t y = 0u; y < Y; ++y)
-			{
-				grid[y][x].x = x;
-				grid[y][x].y = y;
-			}
-
-		grid[0][0].state = GridCellBuild::Queued;
-		cells.push(&grid[0][0]);
-
-		while(!cells.empty())
-		{
-			GridCellBuild& currentCell = *cells.front();
-			cells.pop();
-			intersections = 0;
-			b2Vec2 pos = b2Vec2{0.5f + currentCell.x, 0.5f + currentCell.y};
-			std::vector<SGE::Object*> obstacles = std::move(this->world.getObstacles(pos, 1.5f));
-			for(SGE::Object* o : obstacles)
-			{
-				QuadObstacle* qo = dynamic_cast<QuadObstacle*>(o);
-				if(!qo) continue;
-				for(Edge edge : qo->getEdges())
-				{
-					b2Vec2 radius = -edge.Normal();
-					radius *= 0.5f;
-					float dist = b2DistanceSquared(pos, edge.From());
-					if(dist <= 0.25f)
-					{
-						currentCell.state = GridCellBuild::Invalid;
-						break;
-					}
-					b2Vec2 intersection;
-					if(LineIntersection(pos, pos + radius, edge.From(), edge.To(), dist, intersection))
-					{
-						currentCell.state = GridCellBuild::Invalid;
-						break;
-					}
-					if(LineIntersection(pos, pos + b2Vec2{100.f, 0.f}, edge.From(), edge.To(), dist, intersection))
-					{
-						++intersections;
-					}
-				}
-				if(currentCell.state == GridCellBuild::Invalid || 1 == intersections % 2)
-					break;
-			}
-			if(currentCell.state != GridCellBuild::Invalid && 0 == intersections % 2)
-			{
-				currentCell.state = GridCellBuild::Accepted;
-				currentCell.vertex = new GridVertex(CellLabel(pos));
-				this->gs->graph.AddVertex(currentCell.vertex);
-#ifdef GraphCellDebug
-				currentCell.dummy = new GraphCellDummy(currentCell.x, currentCell.y);
-				graphTestBatch->addObject(currentCell.dummy);
-#endif
-				for(size_t i = 0u; i < 8u; ++i)
-				{
-					auto dir = directions[i];
-					size_t x = currentCell.x + dir.first;
-					size_t y = currentCell.y + dir.second;
-					b2Vec2 edgeVec = b2Vec2{float(dir.first), float(dir.second)};
-					if(x < X && y < Y)
-					{
-						GridCellBuild& otherCell = grid[y][x];
-						switch(otherCell.state)
-						{
-						case GridCellBuild::Accepted:
-						{
-							bool intersected = false;
-							for(SGE::Object* o : obstacles)
-							{
-								QuadObstacle* qo = dynamic_cast<QuadObstacle*>(o);
-								if(!qo) continue;
-								for(Edge edge : qo->getEdges())
-								{
-									b2Vec2(&pts)[4] = i % 2 ? diags : points;
-									for(b2Vec2 offset : pts)
-									{
-										b2Vec2 from = pos + offset;
-										b2Vec2 to = from + edgeVec;
-										float dist;
-										b2Vec2 inters;
-										intersected = LineIntersection(from, to, edge.From(), edge.To(), dist, inters);
-										if(intersected)
-										{
-											break;
-										}
-									}
-									if(intersected) break;
-								}
-								if(intersected) break;
-							}
-							if(!intersected)
-							{
-								this->gs->graph.AddEdge(currentCell.vertex, otherCell.vertex, edgeVec.Length());
-#ifdef GraphEdgeDebug
-								auto edgeOb = new GraphEdgeDummy(pos + 0.5f * edgeVec);
-								edgeOb->setOrientation(edgeVec.Orientation());
-								edgeOb->setLayer(.5f);
-								edgeOb->setShape(SGE::Shape::Rectangle(edgeVec.Length(), 0.05f, true));
-								graphEdgeTestBatch->addObject(edgeOb);
-#endif
-							}
-							break;
-						}
-						case GridCellBuild::Queued: break;
-						case GridCellBuild::Untested:
-						{
-							otherCell.state = GridCellBuild::Queued;
-							cells.push(&otherCell);
-							break;
-						}
-						case GridCellBuild::Invalid: break;
-						default: break;
-						}
-					}
-				}
-			}
-		}
-		for(size_t x = 0u; x < X; ++x)
-		{
-			for(size_t y = 0u; y < Y; ++y)
-			{
-				if(grid[y][x].state == GridCellBuild::Accepted)
-				{
-					auto& cell = this->gs->cells[y][x];
-					cell.state = GridCell::Valid;
-					cell.vertex = grid[y][x].vertex;
-				}
-			}
-		}
-		this->gs->InitRandomEngine();
-//#define ASTARDEBUG
-#ifdef ASTARDEBUG
-		//Test
-		GridVertex* begin = this->gs->cells[0][0].vertex;
-		GridVertex* end = this->gs->cells[Y-1u][X - 1u].vertex;
-		this->gs->graph.AStar(begin, end, DiagonalDistance{});
-		while(end != begin)
-		{
-			graphTestBatch->addObject(new GraphCellDummy(end->Label().position));
-			end = end->Parent();
-		}
-		for(auto v : this->gs->graph)
-		{
-			if(v->State() != CTL::VertexState::White)
-			{
-				graphTestBatch->addObject(new GraphCellDummy1(v->Label().position));
-			}
-		}
-#endif
-	} //!Grid
-
-	//Players
-	{
-		this->gs->bots.reserve(Bots);
-		for(int i = 0; i < Bots; ++i)
-		{
-			this->gs->bots.emplace_back(this->gs->GetRandomVertex()->Label().position, getCircle(), &this->world);
-			RavenBot* bot = &this->gs->bots.back();
-			botBatch->addObject(bot);
-			this->world.AddMover(bot);
-			bot->RailgunTrace = new RGTrace();
-			this->gs->railBatch->addObject(bot->RailgunTrace);
-		}
-	}
-
-	//Items
-	{
-		this->gs->GenerateItems<HealthPack>(Bots, healthBatch);
-		this->gs->GenerateItems<ArmorPack>(Bots, armorBatch);
-		this->gs->GenerateItems<RocketAmmo>(Bots, rlammoBatch);
-		this->gs->GenerateItems<RailgunAmmo>(Bots, rgammoBatch);
-	}
-	
 	//Logics
-	this->addLogic(new SteeringBehavioursUpdate(&this->gs->bots));
-	this->addLogic(new SeparateBots(&this->world, &this->gs->bots));
-	this->addLogic(new MoveAwayFromObstacle(&this->world, this->gs->obstacles));
-	this->addLogic(new MoveAwayFromWall(&this->world, this->gs->bots));
-	this->addLogic(new BotLogic(&this->world, this->gs));
-	this->addLogic(new ItemLogic(&this->world, this->gs));
-	this->addLogic(new RocketLogic(this->gs, &this->world));
+	SimulationStep* simulation = new SimulationStep(&this->gs->clock);
+	simulation->AddLogic(new PartitionSync(&this->world));
+	simulation->AddLogic(new NeighbourListUpdate(&this->world, &this->gs->bots));
+	simulation->AddLogic(new SteeringBehavioursUpdate(&this->gs->bots, &this->gs->clock));
+	simulation->AddLogic(new SeparateBots(&this->world, &this->gs->bots, this->gs->SimulationPool()));
+	simulation->AddLogic(new MoveAwayFromObstacle(&this->world, this->gs->obstacles));
+	simulation->AddLogic(new MoveAwayFromWall(&this->world, this->gs->bots));
+	simulation->AddLogic(new BotLogic(&this->world, this->gs));
+	simulation->AddLogic(new ItemLogic(&this->world, this->gs));
+	simulation->AddLogic(new RocketLogic(this->gs, &this->world));
+	this->addLogic(simulation);
 }
 
 void RavenScene::unloadScene()
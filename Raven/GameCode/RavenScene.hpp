@@ -3,61 +3,109 @@
 
 #include <Game/sge_game.hpp>
 #include <Scene/sge_scene.hpp>
+#include <random>
+#include <memory>
 #include "RavenBot.hpp"
 #include "World.hpp"
 #include "GridGraph.hpp"
+#include "JumpPointSearch.hpp"
+#include "HierarchicalPlanner.hpp"
+#include "PathCache.hpp"
+#include "PotentiallyVisibleSet.hpp"
+#include "ThreadPool.hpp"
 #include "Objects.hpp"
 #include "Actions.hpp"
+#include "SimulationClock.hpp"
 
 namespace SGE
 {
 	class RealSpriteBatch;
 }
-
-struct GridCell
-{
-	enum State
-	{
-		Valid, Invalid
-	} state = Invalid;
-	GridVertex* vertex = nullptr;
-};
+class QuadBatch;
 
 constexpr float Width = 80.f;
 constexpr float Height = 60.f;
 constexpr size_t X = size_t(Width);
 constexpr size_t Y = size_t(Height);
+constexpr size_t Bots = 5u;
+
+//Batches used to display generated level, any of them may be null (e.g. when running headless)
+struct RavenBatches
+{
+	QuadBatch* obstacles = nullptr;
+	SGE::RealSpriteBatch* bots = nullptr;
+	SGE::RealSpriteBatch* health = nullptr;
+	SGE::RealSpriteBatch* armor = nullptr;
+	SGE::RealSpriteBatch* rlammo = nullptr;
+	SGE::RealSpriteBatch* rgammo = nullptr;
+	SGE::RealSpriteBatch* graphCells = nullptr;
+	SGE::RealSpriteBatch* graphEdges = nullptr;
+};
 
 class RavenGameState
 {
 protected:
 	std::function<size_t()> rand;
+	std::unique_ptr<ThreadPool> simulationPool;
 public:
 	GridCell cells[Y][X];
 	GridGraph graph;
+	GridCSR navgraph;
+	GridSearch search;
+	PathCache pathCache;
+	JumpPointSearch jps;
+	HierarchicalPlanner hpa;
+	Planner planner = Planner::JumpPoint;
+	//Worker threads searching bot paths, 0 spreads searches over ticks on simulation thread
+	unsigned pathThreads = 0u;
+	//Worker threads helping simulation thread with bot separation, lines of sight, railgun shots and building cell
+	//visibility table
+	unsigned simulationThreads = 0u;
+	//Cell visibility, built by GenerateLevel when buildVisibility is set. Tables are kept in visibilityCache
+	//directory unless it is empty. Every seed generates another level and table, so set it only for a fixed seed
+	PotentiallyVisibleSet pvs;
+	bool buildVisibility = false;
+	std::string visibilityCache;
 	World* world = nullptr;
-	SGE::RealSpriteBatch* railBatch;
-	SGE::RealSpriteBatch* rocketBatch;
-	SGE::RealSpriteBatch* explosionBatch;
+	SGE::RealSpriteBatch* railBatch = nullptr;
+	SGE::RealSpriteBatch* rocketBatch = nullptr;
+	SGE::RealSpriteBatch* explosionBatch = nullptr;
 	std::vector<SGE::Object*> obstacles;
 	std::vector<RavenBot> bots;
 	std::vector<Rocket*> rockets;
 	std::vector<Rocket*> explosions;
 	std::vector<Item*> items;
+	SimulationClock clock;
+	unsigned seed = std::random_device{}();
+	//Wander jitter of all bots, seeded from seed by InitRandomEngine
+	std::default_random_engine wanderEngine;
 
 	void InitRandomEngine();
+	//Workers shared by simulation logics, started with simulationThreads on first use
+	ThreadPool& SimulationPool();
 
 	GridCell* GetCell(b2Vec2 pos);
 
 	GridVertex* GetVertex(b2Vec2 pos);
 	GridVertex* GetRandomVertex();
 	GridVertex* GetRandomVertex(const b2Vec2& position, const float limit, bool inside);
+	//Random vertex at least limit away from threat, which cell visibility table hides from it when some tried one is
+	GridVertex* GetCoverVertex(const b2Vec2& threat, const float limit);
+	//Cached path if there is one, otherwise PlanPath
 	Path GetPath(GridVertex* begin, GridVertex* end);
+	Path PlanPath(GridVertex* begin, GridVertex* end);
+	Path NavgraphPath(const std::vector<GridCSR::Index>& vertices) const;
+	Path CellPath(const std::vector<JumpPointSearch::Index>& cells) const;
 
 	void UseItem(Item* item);
 
 	template<typename T>
 	void GenerateItems(const size_t bots, SGE::RealSpriteBatch* batch);
+	void GenerateObstacles(QuadBatch* batch);
+	void GenerateGraph(SGE::RealSpriteBatch* graphTestBatch, SGE::RealSpriteBatch* graphEdgeTestBatch);
+	void GenerateVisibility();
+	void GenerateBots(const size_t bots, SGE::RealSpriteBatch* batch);
+	void GenerateLevel(const size_t bots, const RavenBatches& batches);
 	void NewRocket(b2Vec2 pos, b2Vec2 direction);
 	void AddExplosion(Rocket* rocket);
 	void RemoveRocket(Rocket* rocket);
@@ -71,6 +119,9 @@ protected:
 	SGE::Game* game = nullptr;
 	std::string path;
 	RavenGameState* gs = nullptr;
+	//Level seed of every load when fixedSeed is set, otherwise each load draws a new one
+	unsigned seed = 0u;
+	bool fixedSeed = false;
 
 	static bool init();
 public:
@@ -78,6 +129,9 @@ public:
 
 	RavenScene(SGE::Game* game, const char* path);
 
+	//Generates the same level on every load, which lets cell visibility table be kept on disk
+	void FixSeed(unsigned seed);
+
 	virtual void loadScene() override;
 	virtual void unloadScene() override;
 
@@ -0,0 +1,131 @@
+#ifndef CTL_SEARCH_CONTEXT
+#define CTL_SEARCH_CONTEXT
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "Graph.hpp"
+#include "Heap.hpp"
+
+namespace CTL
+{
+	enum class SearchStatus
+	{
+		Searching,
+		Found,
+		Failed
+	};
+
+	//Per-query search state kept outside of graph vertices.
+	//Nodes are reset lazily through generation counter, so starting a query costs O(1)
+	//and a query costs O(nodes touched). One context per concurrent search.
+	//Q is the open list, QuadHeap or LazyQueue.
+	template<typename I = std::uint32_t, template<typename> class Q = QuadHeap>
+	class SearchContext
+	{
+	public:
+		using Index = I;
+		static constexpr Index None = std::numeric_limits<Index>::max();
+
+	private:
+		struct Node
+		{
+			float distance = std::numeric_limits<float>::infinity();
+			Index parent = None;
+			VertexState state = VertexState::White;
+			std::uint32_t generation = 0u;
+		};
+		std::vector<Node> nodes;
+		std::uint32_t generation = 0u;
+		size_t expanded = 0u;
+
+		Node& Touch(Index v)
+		{
+			Node& n = this->nodes[v];
+			if(n.generation != this->generation)
+			{
+				n.distance = std::numeric_limits<float>::infinity();
+				n.parent = None;
+				n.state = VertexState::White;
+				n.generation = this->generation;
+			}
+			return n;
+		}
+
+	public:
+		//Open list storage, kept here so its capacity survives between queries
+		Q<float> open;
+
+		void Begin(size_t vertexCount)
+		{
+			if(this->nodes.size() < vertexCount)
+			{
+				this->nodes.resize(vertexCount);
+			}
+			if(++this->generation == 0u)
+			{
+				for(Node& n : this->nodes)
+				{
+					n.generation = 0u;
+				}
+				this->generation = 1u;
+			}
+			this->expanded = 0u;
+			this->open.Clear();
+			this->open.Reserve(vertexCount);
+		}
+
+		float Distance(Index v) const
+		{
+			const Node& n = this->nodes[v];
+			return n.generation == this->generation ? n.distance : std::numeric_limits<float>::infinity();
+		}
+
+		Index Parent(Index v) const
+		{
+			const Node& n = this->nodes[v];
+			return n.generation == this->generation ? n.parent : None;
+		}
+
+		VertexState State(Index v) const
+		{
+			const Node& n = this->nodes[v];
+			return n.generation == this->generation ? n.state : VertexState::White;
+		}
+
+		void Relax(Index v, Index parent, float distance)
+		{
+			Node& n = this->Touch(v);
+			n.distance = distance;
+			n.parent = parent;
+			n.state = VertexState::Gray;
+		}
+
+		void Close(Index v)
+		{
+			this->Touch(v).state = VertexState::Black;
+			++this->expanded;
+		}
+
+		size_t Expanded() const
+		{
+			return this->expanded;
+		}
+
+		//Appends vertices from end to begin (begin excluded), false if end was not reached
+		bool Unwind(Index begin, Index end, std::vector<Index>& path) const
+		{
+			path.clear();
+			if(begin != end && this->Parent(end) == None) return false;
+			for(Index v = end; v != begin; v = this->Parent(v))
+			{
+				path.push_back(v);
+			}
+			return true;
+		}
+	};
+
+	template<typename I, template<typename> class Q>
+	constexpr I SearchContext<I, Q>::None;
+}
+#endif // !CTL_SEARCH_CONTEXT
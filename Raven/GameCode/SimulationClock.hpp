@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+
+//Fixed timestep clock with accumulator.
+//Physics and steering run every tick, decision logic runs every decisionRate ticks.
+class SimulationClock
+{
+protected:
+	float tick = 1.f / 120.f;
+	unsigned decisionRate = 4u;
+	unsigned maxSteps = 8u;
+	float accumulator = 0.f;
+	std::uint64_t ticks = 0u;
+public:
+	SimulationClock() = default;
+	SimulationClock(float tick, unsigned decisionRate, unsigned maxSteps = 8u)
+		: tick(tick), decisionRate(decisionRate ? decisionRate : 1u), maxSteps(maxSteps)
+	{}
+
+	//Adds frame time and returns number of fixed ticks to run, at most maxSteps
+	unsigned Advance(float frameTime)
+	{
+		this->accumulator += frameTime;
+		unsigned steps = 0u;
+		while(this->accumulator >= this->tick && steps < this->maxSteps)
+		{
+			this->accumulator -= this->tick;
+			++steps;
+		}
+		if(steps == this->maxSteps && this->accumulator >= this->tick)
+		{
+			//Drop the backlog instead of spiralling after a long hitch
+			this->accumulator = 0.f;
+		}
+		return steps;
+	}
+
+	void BeginTick()
+	{
+		++this->ticks;
+	}
+
+	void Reset()
+	{
+		this->accumulator = 0.f;
+		this->ticks = 0u;
+	}
+
+	float Delta() const
+	{
+		return this->tick;
+	}
+
+	float DecisionDelta() const
+	{
+		return this->tick * this->decisionRate;
+	}
+
+	bool IsDecisionTick() const
+	{
+		return (this->ticks - 1u) % this->decisionRate == 0u;
+	}
+
+	std::uint64_t Ticks() const
+	{
+		return this->ticks;
+	}
+
+	double Time() const
+	{
+		return double(this->ticks) * this->tick;
+	}
+
+	//Fraction of a tick left in accumulator, for render interpolation
+	float Alpha() const
+	{
+		return this->accumulator / this->tick;
+	}
+};
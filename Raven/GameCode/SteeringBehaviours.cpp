@@ -6,7 +6,6 @@
 #include "Utilities.hpp"
 #include "World.hpp"
 #include "Wall.hpp"
-#include "Utils/Timing/sge_fps_limiter.hpp"
 
 SteeringBehaviours::SteeringBehaviours(RavenBot* owner): owner(owner)
 {
@@ -17,13 +16,13 @@ SteeringBehaviours::SteeringBehaviours(RavenBot* owner): owner(owner)
 SteeringBehaviours::~SteeringBehaviours()
 {}
 
-b2Vec2 SteeringBehaviours::CalculateForce()
+b2Vec2 SteeringBehaviours::CalculateForce(float delta)
 {
 	constexpr float alone_time_max = 15.f;
 	constexpr float wander_time_max = 15.f;
 	float distCoef = b2Clamp(b2Distance(this->enemy->getPosition(), this->owner->getPosition()), 10.f, 100.f);
 	distCoef = 1.f + (100.f - distCoef) * 0.05f;
-	if(((this->total_space_time += SGE::delta_time) > 240.f))
+	if(((this->total_space_time += delta) > 240.f))
 		this->owner->setState(BotState::Attacking);
 
 	b2Vec2 sForce = b2Vec2_zero;
@@ -42,7 +41,7 @@ b2Vec2 SteeringBehaviours::CalculateForce()
 	}
 	else
 	{
-		this->alone_time += SGE::delta_time;
+		this->alone_time += delta;
 	}
 
 	if(this->owner->IsAttacking())
@@ -133,14 +132,10 @@ b2Vec2 SteeringBehaviours::Evade(const RavenBot* const pursuer) const
 	return Flee(pursuer->getPosition() + lookAhead * pursuer->getVelocity());
 }
 
-namespace
-{
-	auto randClamped = std::bind(std::uniform_real_distribution<float>(-1.f, 1.f),
-								 std::default_random_engine());
-}
 b2Vec2 SteeringBehaviours::Wander()
 {
-	this->wTarget += b2Vec2{randClamped()*this->wJitter, randClamped()*this->wJitter};
+	std::uniform_real_distribution<float> randClamped(-1.f, 1.f);
+	this->wTarget += b2Vec2{randClamped(*this->random)*this->wJitter, randClamped(*this->random)*this->wJitter};
 	this->wTarget.Normalize();
 	this->wTarget *= this->wRadius;
 	b2Vec2 target = this->wTarget + b2Vec2{this->wDistance, 0.f};
@@ -152,11 +147,11 @@ b2Vec2 SteeringBehaviours::Wander()
 b2Vec2 SteeringBehaviours::ObstacleAvoidance()
 {
 	this->boxLength = 4.f*(1.f + owner->getSpeed() / owner->getMaxSpeed());
-	std::vector<SGE::Object*> obstacles = owner->getWorld()->getObstacles(owner, this->boxLength);
+	owner->getWorld()->getObstacles(this->obstacles, owner, this->boxLength);
 	SGE::Object* closestObject = nullptr;
 	float closestDist = std::numeric_limits<float>::max();
 	b2Vec2 closestLocalPos = b2Vec2_zero;
-	for(SGE::Object* ob : obstacles)
+	for(SGE::Object* ob : this->obstacles)
 	{
 		if(ob->getShape()->getType() != SGE::ShapeType::Quad)
 		{
@@ -206,12 +201,7 @@ b2Vec2 SteeringBehaviours::ObstacleAvoidance()
 		auto qob = reinterpret_cast<QuadObstacle*>(closestObject);
 		if(qob)
 		{
-			std::vector<std::pair<SGE::Object*, Edge>> Vector;
-			for(auto edge : qob->getEdges())
-			{
-				Vector.emplace_back(qob, edge);
-			}
-			return this->WallAvoidanceImp(Vector);
+			return this->WallAvoidanceImp(qob);
 		}
 		else
 		{
@@ -234,7 +224,7 @@ void SteeringBehaviours::CreateFeelers()
 	this->feelers[2] = owner->getPosition() + 3.f * temp;
 }
 
-b2Vec2 SteeringBehaviours::WallAvoidanceImp(std::vector<std::pair<SGE::Object*, Edge>>& walls)
+b2Vec2 SteeringBehaviours::WallAvoidanceImp(const SGE::Object* obstacle)
 {
 	this->CreateFeelers();
 	float distToIp = 0.f;
@@ -243,20 +233,20 @@ b2Vec2 SteeringBehaviours::WallAvoidanceImp(std::vector<std::pair<SGE::Object*,
 	b2Vec2 sForce = b2Vec2_zero;
 	b2Vec2 point = b2Vec2_zero;
 	b2Vec2 closestPoint = b2Vec2_zero;
+	const EdgeTree& edges = owner->getWorld()->getStaticEdges();
+	const EdgeTree::Entry* wall;
 	for(b2Vec2 feeler : this->feelers)
 	{
-		for(auto& wall : walls)
+		if(edges.Raycast(owner->getPosition(), feeler, distToIp, point, wall, [obstacle](const EdgeTree::Entry& entry)
+		{
+			return obstacle ? entry.owner == obstacle : entry.edge.Type() != Wall::Invalid;
+		}))
 		{
-			if(LineIntersection(owner->getPosition(), feeler,
-			                    wall.second.From(), wall.second.To(),
-			                    distToIp, point))
+			if(distToIp < closestDistToIp)
 			{
-				if(distToIp < closestDistToIp)
-				{
-					closestDistToIp = distToIp;
-					closestWall = wall.second;
-					closestPoint = point;
-				}
+				closestDistToIp = distToIp;
+				closestWall = wall->edge;
+				closestPoint = point;
 			}
 		}
 		if(closestPoint != b2Vec2_zero)
@@ -270,8 +260,7 @@ b2Vec2 SteeringBehaviours::WallAvoidanceImp(std::vector<std::pair<SGE::Object*,
 
 b2Vec2 SteeringBehaviours::WallAvoidance()
 {
-	std::vector<std::pair<SGE::Object*, Edge>>& walls = owner->getWorld()->getWalls();
-	return WallAvoidanceImp(walls);
+	return WallAvoidanceImp();
 }
 
 b2Vec2 SteeringBehaviours::Interpose(const RavenBot* const aA, const RavenBot* const aB) const
@@ -304,8 +293,8 @@ b2Vec2 SteeringBehaviours::Hide(const RavenBot* const target, bool runaway, cons
 	}
 	else
 	{
-		std::vector<SGE::Object*> obstacles = owner->getWorld()->getObstacles(owner, 30.f);
-		for(SGE::Object* ob : obstacles)
+		owner->getWorld()->getObstacles(this->obstacles, owner, 30.f);
+		for(SGE::Object* ob : this->obstacles)
 		{
 			b2Vec2 spot = this->GetHidingSpot(ob->getPosition(), ob->getShape()->getRadius(), target->getPosition());
 			float dist = b2DistanceSquared(spot, owner->getPosition());
@@ -391,7 +380,7 @@ b2Vec2 SteeringBehaviours::Cohesion(const std::vector<RavenBot*>& neighbours) co
 	return sForce;
 }
 
-b2Vec2 RavenSteering::CalculateForce()
+b2Vec2 RavenSteering::CalculateForce(float)
 {
 	b2Vec2 sForce = b2Vec2_zero;
 	sForce += 0.5f * this->WallAvoidance();
@@ -401,6 +390,11 @@ b2Vec2 RavenSteering::CalculateForce()
 	{
 		sForce += 2.f * this->FollowPath();
 	}
+	else if(this->owner->IsWaitingForPath())
+	{
+		//Keeps moving until requested path arrives
+		sForce += 0.5f * this->Wander();
+	}
 	
 	this->owner->getWorld()->getNeighbours(this->neighbours, this->owner, 10.f);
 
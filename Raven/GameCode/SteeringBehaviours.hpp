@@ -1,6 +1,7 @@
 #pragma once
 #include "Box2D/Common/b2Math.h"
 #include <array>
+#include <random>
 #include <vector>
 #include "Path.hpp"
 #include "Wall.hpp"
@@ -27,6 +28,10 @@ protected:
 	const RavenBot* enemy = nullptr;
 	const SGE::Object* obstacle = nullptr;
 	std::vector<RavenBot*> neighbours;
+	//Engine of wander jitter, owned by game state
+	std::default_random_engine* random = nullptr;
+	//Query buffer reused between ticks
+	mutable std::vector<SGE::Object*> obstacles;
 	b2Vec2 wTarget = b2Vec2_zero;
 	Path path;
 	float wRadius = 2.5f;
@@ -37,13 +42,14 @@ protected:
 	float total_space_time = 0.0f;
 	float alone_time = 0.0f;
 	void CreateFeelers();
-	b2Vec2 WallAvoidanceImp(std::vector<std::pair<SGE::Object*, Edge>>& walls);
+	//Feelers against level walls, or against edges of obstacle when it is given
+	b2Vec2 WallAvoidanceImp(const SGE::Object* obstacle = nullptr);
 	static b2Vec2 GetHidingSpot(const b2Vec2& obPos, float obRadius, b2Vec2 targetPos);
 
 public:
 	SteeringBehaviours(RavenBot* owner);
 	virtual ~SteeringBehaviours();
-	virtual b2Vec2 CalculateForce();
+	virtual b2Vec2 CalculateForce(float delta);
 	b2Vec2 Seek(b2Vec2 target) const;
 	b2Vec2 Flee(b2Vec2 target) const;
 	b2Vec2 Arrive(b2Vec2 target, Deceleration dec) const;
@@ -75,6 +81,11 @@ public:
 		this->path.Clear();
 	}
 
+	void setRandomEngine(std::default_random_engine* random)
+	{
+		this->random = random;
+	}
+
 	void setEnemy(const RavenBot* const enemy)
 	{
 		this->enemy = enemy;
@@ -101,7 +112,7 @@ class RavenSteering: public SteeringBehaviours
 public:
 	using SteeringBehaviours::SteeringBehaviours;
 	virtual ~RavenSteering() override = default;
-	virtual b2Vec2 CalculateForce() override;
+	virtual b2Vec2 CalculateForce(float delta) override;
 
 };
 
@@ -1,33 +1,32 @@
 #include "SteeringBehavioursUpdate.hpp"
-#include "Utils/Timing/sge_fps_limiter.hpp"
 #include "Box2D/Common/b2Math.h"
 #include "RavenBot.hpp"
 #include "World.hpp"
 
-SteeringBehavioursUpdate::SteeringBehavioursUpdate(std::vector<RavenBot>* objects): Logic(SGE::LogicPriority::Highest), objects(objects)
+SteeringBehavioursUpdate::SteeringBehavioursUpdate(std::vector<RavenBot>* objects, const SimulationClock* clock)
+	: Logic(SGE::LogicPriority::Highest), objects(objects), clock(clock)
 {}
 
 void SteeringBehavioursUpdate::performLogic()
 {
+	const float delta = this->clock->Delta();
 	for(RavenBot& o : *this->objects)
 	{
 		b2Vec2 heading = o.getVelocity();
 		heading.Normalize();
 		o.setHeading(heading);
-		b2Vec2 sForce = o.getSteering()->CalculateForce();
+		b2Vec2 sForce = o.getSteering()->CalculateForce(delta);
 		sForce.Truncate(o.getMaxForce());
 		b2Vec2 acceleration = o.getMassInv() * sForce;
-		b2Vec2 velocity = o.getVelocity() + SGE::delta_time * acceleration;
+		b2Vec2 velocity = o.getVelocity() + delta * acceleration;
 		velocity.Truncate(o.getMaxSpeed());
 		o.setVelocity(velocity);
-		auto oldPos = o.getPosition();
-		o.setPosition(oldPos + SGE::delta_time * o.getVelocity());
+		o.setPosition(o.getPosition() + delta * o.getVelocity());
 		if(o.getVelocity().LengthSquared() > 0.01f)
 		{
 			velocity.Normalize();
 			o.setHeading(velocity);
 			o.setSide(velocity.Skew());
 		}
-		o.getWorld()->UpdateMover(&o, oldPos);
 	}
 }
\ No newline at end of file
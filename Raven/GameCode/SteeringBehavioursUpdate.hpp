@@ -2,12 +2,14 @@
 #include <Logic/sge_logic.hpp>
 #include <vector>
 #include "RavenBot.hpp"
+#include "SimulationClock.hpp"
 
 class SteeringBehavioursUpdate: public SGE::Logic
 {
 protected:
 	std::vector<RavenBot>* objects = nullptr;
+	const SimulationClock* clock = nullptr;
 public:
-	explicit SteeringBehavioursUpdate(std::vector<RavenBot>* objects);
+	SteeringBehavioursUpdate(std::vector<RavenBot>* objects, const SimulationClock* clock);
 	virtual void performLogic() override;
 };
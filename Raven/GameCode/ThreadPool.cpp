@@ -0,0 +1,56 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+	this->workers.reserve(threads);
+	for(unsigned i = 0u; i < threads; ++i)
+	{
+		this->workers.emplace_back(&ThreadPool::Work, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	for(std::thread& worker : this->workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::Work()
+{
+	while(true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->wake.wait(lock, [this]
+			{
+				return this->stopping || !this->tasks.empty();
+			});
+			if(this->tasks.empty()) return;
+			task = std::move(this->tasks.front());
+			this->tasks.pop_front();
+		}
+		task();
+	}
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->tasks.push_back(std::move(task));
+	}
+	this->wake.notify_one();
+}
+
+size_t ThreadPool::Size() const
+{
+	return this->workers.size();
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+//Fixed set of worker threads running queued tasks in submission order
+class ThreadPool
+{
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+
+	void Work();
+public:
+	explicit ThreadPool(unsigned threads);
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	//Runs tasks still queued, then joins workers
+	~ThreadPool();
+
+	void Enqueue(std::function<void()> task);
+	size_t Size() const;
+
+	//Splits [0, count) into Size() + 1 contiguous chunks and calls body(chunk, begin, end) for each of them,
+	//the first one on the calling thread. Chunk bounds depend only on count and Size(). Returns once all are done
+	template<typename F>
+	void ParallelFor(size_t count, F body)
+	{
+		const size_t chunks = this->workers.size() + 1u;
+		auto bound = [count, chunks](size_t chunk)
+		{
+			return count * chunk / chunks;
+		};
+		size_t remaining = chunks - 1u;
+		std::mutex doneMutex;
+		std::condition_variable done;
+		for(size_t chunk = 1u; chunk < chunks; ++chunk)
+		{
+			this->Enqueue([&body, &bound, &remaining, &doneMutex, &done, chunk]
+			{
+				body(chunk, bound(chunk), bound(chunk + 1u));
+				std::lock_guard<std::mutex> lock(doneMutex);
+				if(--remaining == 0u) done.notify_one();
+			});
+		}
+		body(0u, bound(0u), bound(1u));
+		std::unique_lock<std::mutex> lock(doneMutex);
+		done.wait(lock, [&remaining]
+		{
+			return remaining == 0u;
+		});
+	}
+};
@@ -1,4 +1,7 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <Object/Shape/sge_shape.hpp>
 #include <Box2D/Common/b2Math.h>
 
@@ -70,6 +73,78 @@ inline bool LineIntersection(b2Vec2 a, b2Vec2 b,
 	}
 }
 
+//Parameters t in [t0, t1] at which from + t * motion is closer than radius to centre, false when there are none
+inline bool CircleInterval(b2Vec2 from, b2Vec2 motion, b2Vec2 centre, float radius, float& t0, float& t1)
+{
+	const b2Vec2 offset = from - centre;
+	const float a = b2Dot(motion, motion), b = b2Dot(offset, motion), c = b2Dot(offset, offset) - radius * radius;
+	if(a == 0.f)
+	{
+		if(c >= 0.f) return false;
+		t0 = -std::numeric_limits<float>::infinity();
+		t1 = std::numeric_limits<float>::infinity();
+		return true;
+	}
+	const float discriminant = b * b - a * c;
+	if(discriminant <= 0.f) return false;
+	const float root = std::sqrt(discriminant);
+	t0 = (-b - root) / a;
+	t1 = (-b + root) / a;
+	return true;
+}
+
+//Same for points closer than radius to segment c-d. Capsule is convex, so it is the hull of intervals
+//of its end circles and of the strip between them
+inline bool CapsuleInterval(b2Vec2 from, b2Vec2 motion, b2Vec2 c, b2Vec2 d, float radius, float& t0, float& t1)
+{
+	constexpr float inf = std::numeric_limits<float>::infinity();
+	float low = inf, high = -inf, l, h;
+	for(b2Vec2 end : {c, d})
+	{
+		if(!CircleInterval(from, motion, end, radius, l, h)) continue;
+		low = std::min(low, l);
+		high = std::max(high, h);
+	}
+	b2Vec2 along = d - c;
+	const float length = along.Normalize();
+	if(length > 0.f)
+	{
+		l = -inf;
+		h = inf;
+		//Value start + rate * t has to stay between bounds
+		auto slab = [&l, &h](float start, float rate, float lowBound, float highBound)
+		{
+			if(rate == 0.f)
+			{
+				if(start <= lowBound || start >= highBound) l = inf;
+				return;
+			}
+			const float a = (lowBound - start) / rate, b = (highBound - start) / rate;
+			l = std::max(l, std::min(a, b));
+			h = std::min(h, std::max(a, b));
+		};
+		slab(b2Dot(from - c, along.Skew()), b2Dot(motion, along.Skew()), -radius, radius);
+		slab(b2Dot(from - c, along), b2Dot(motion, along), 0.f, length);
+		if(l < h)
+		{
+			low = std::min(low, l);
+			high = std::max(high, h);
+		}
+	}
+	if(low >= high) return false;
+	t0 = low;
+	t1 = high;
+	return true;
+}
+
+//First contact in [0, 1] of motion with an object it overlaps during [t0, t1]. Objects it only moves out of do not count
+inline bool TimeOfImpact(float t0, float t1, float& toi)
+{
+	if(t0 > 1.f || t1 < 0.f || (t0 <= 0.f && t1 < 1.f)) return false;
+	toi = std::max(t0, 0.f);
+	return true;
+}
+
 inline b2Vec2 PointToWorldSpace(const b2Vec2& point, const b2Vec2& heading, const b2Vec2& position)
 {
 	auto orientation = heading.Orientation();
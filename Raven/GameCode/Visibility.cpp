@@ -0,0 +1,83 @@
+#include "Visibility.hpp"
+
+Visibility::Visibility(World* world, const PotentiallyVisibleSet* pvs, ThreadPool& pool)
+	: world(world), pvs(pvs), pool(pool), buffers(pool.Size() + 1u)
+{}
+
+void Visibility::Update(std::vector<RavenBot>& bots, const std::vector<Item*>& items)
+{
+	this->botCount = bots.size();
+	this->itemCount = items.size();
+	this->bots.resize(this->botCount * this->botCount);
+	this->items.resize(this->botCount * this->itemCount);
+	//Static edges are built lazily, which must not happen on the workers
+	this->world->getStaticEdges();
+	this->pool.ParallelFor(bots.size(), [this, &bots, &items](size_t chunk, size_t begin, size_t end)
+	{
+		std::vector<RavenBot*>& buffer = this->buffers[chunk];
+		for(size_t observer = begin; observer < end; ++observer)
+		{
+			RavenBot& bot = bots[observer];
+			const b2Vec2 pos = bot.getPosition();
+			const b2Vec2 heading = bot.getHeading();
+			Sight<RavenBot>* botRow = &this->bots[observer * this->botCount];
+			for(size_t target = 0u; target < bots.size(); ++target)
+			{
+				botRow[target] = Sight<RavenBot>{nullptr, false};
+				if(target == observer) continue;
+				b2Vec2 direction = bots[target].getPosition() - pos;
+				const float distance = direction.Normalize();
+				if(bot.enemies.count(&bots[target]) == 0u && !InFieldOfView(heading, direction)) continue;
+				if(!this->pvs->Visible(pos, bots[target].getPosition()))
+				{
+					botRow[target].traced = true;
+					continue;
+				}
+				//Target is met before the ray reaches its centre
+				botRow[target] = Sight<RavenBot>{this->world->RaycastBot(&bot, pos, direction, buffer, distance).entity, true};
+			}
+			Sight<Item>* itemRow = &this->items[observer * this->itemCount];
+			for(size_t item = 0u; item < items.size(); ++item)
+			{
+				itemRow[item] = Sight<Item>{nullptr, false};
+				const b2Vec2 direction = items[item]->getPosition() - pos;
+				if(bot.items.count(items[item]) != 0u || !InFieldOfView(heading, direction)) continue;
+				if(!this->pvs->Visible(pos, items[item]->getPosition()))
+				{
+					itemRow[item].traced = true;
+					continue;
+				}
+				itemRow[item] = Sight<Item>{this->world->RaycastItem(pos, direction, direction.Length()).entity, true};
+			}
+		}
+	});
+	this->botsValid = true;
+	this->itemsValid = true;
+}
+
+void Visibility::Invalidate()
+{
+	this->botsValid = false;
+	this->itemsValid = false;
+}
+
+void Visibility::InvalidateItems()
+{
+	this->itemsValid = false;
+}
+
+bool Visibility::SeenBot(size_t observer, size_t target, RavenBot*& hit) const
+{
+	if(!this->botsValid || observer >= this->botCount || target >= this->botCount) return false;
+	const Sight<RavenBot>& sight = this->bots[observer * this->botCount + target];
+	hit = sight.hit;
+	return sight.traced;
+}
+
+bool Visibility::SeenItem(size_t observer, size_t item, Item*& hit) const
+{
+	if(!this->itemsValid || observer >= this->botCount || item >= this->itemCount) return false;
+	const Sight<Item>& sight = this->items[observer * this->itemCount + item];
+	hit = sight.hit;
+	return sight.traced;
+}
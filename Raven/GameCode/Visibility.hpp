@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include "ThreadPool.hpp"
+#include "World.hpp"
+#include "PotentiallyVisibleSet.hpp"
+
+//Whether toTarget points into the field of view of a bot facing heading
+inline bool InFieldOfView(b2Vec2 heading, b2Vec2 toTarget)
+{
+	return b2Abs(b2Atan2(b2Cross(heading, toTarget), b2Dot(heading, toTarget))) < 0.25f * b2_pi;
+}
+
+//Lines of sight of every bot to every other bot and item, traced once per decision pass.
+//Targets a bot does not know about and cannot see because of its field of view are culled before any ray
+//is cast, as are targets in cells hidden by cell visibility table. Rays left for each bot are traced together
+//on the pool. Results are for positions at Update,
+//once bots move or items are taken during the pass they are stale and callers cast their own rays.
+class Visibility
+{
+	template<typename T>
+	struct Sight
+	{
+		//First hit on the ray towards the target
+		T* hit;
+		bool traced;
+	};
+	World* world;
+	const PotentiallyVisibleSet* pvs;
+	ThreadPool& pool;
+	//Per chunk raycast buffers
+	std::vector<std::vector<RavenBot*>> buffers;
+	//Row per observing bot, column per target in game state order
+	std::vector<Sight<RavenBot>> bots;
+	std::vector<Sight<Item>> items;
+	size_t botCount = 0u, itemCount = 0u;
+	bool botsValid = false, itemsValid = false;
+public:
+	Visibility(World* world, const PotentiallyVisibleSet* pvs, ThreadPool& pool);
+
+	void Update(std::vector<RavenBot>& bots, const std::vector<Item*>& items);
+	//Bots moved since Update
+	void Invalidate();
+	//Items were taken since Update
+	void InvalidateItems();
+
+	//False when the pair was not traced or results are stale, otherwise hit is what the ray met first
+	bool SeenBot(size_t observer, size_t target, RavenBot*& hit) const;
+	bool SeenItem(size_t observer, size_t item, Item*& hit) const;
+};
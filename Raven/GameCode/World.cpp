@@ -2,42 +2,57 @@
 #include "Utilities.hpp"
 #include "Logics.hpp"
 
-World::World(float width, float height)
-	: movers(width, height), obstacles(width, height), items(width, height), rockets(width, height), walls(),
-	width(width), height(height), cellWidth(width / partitionX), cellHeight(height / partitionY)
+namespace
+{
+	//Distance along unit direction where ray enters circle, 0 when it starts inside.
+	//False when circle is missed or its centre is behind the origin
+	bool RayCircle(b2Vec2 from, b2Vec2 direction, b2Vec2 centre, float radius, float& distance)
+	{
+		const b2Vec2 offset = centre - from;
+		const float along = b2Dot(offset, direction);
+		if(along < 0.f) return false;
+		const float across = b2Cross(direction, offset);
+		if(b2Abs(across) >= radius) return false;
+		const float half = std::sqrt(radius * radius - across * across);
+		distance = std::max(along - half, 0.f);
+		return true;
+	}
+}
+
+World::World(float width, float height, float queryRadius, float entityRadius, PartitionStorage storage)
+	: grid(PartitionGrid::Tuned(width, height, queryRadius, entityRadius)),
+	movers(width, height, grid, PartitionMode::Centre, storage), obstacles(width, height, grid, PartitionMode::Overlap, storage),
+	rockets(width, height, grid, PartitionMode::Centre, storage), items(width, height, grid, PartitionMode::Overlap, storage), walls(),
+	neighbourList(neighbourListRadius, neighbourListSkin),
+	width(width), height(height), cellWidth(width / grid.x), cellHeight(height / grid.y)
 {
 	walls.reserve(4);
 }
 
-std::vector<SGE::Object*> World::getObstacles(RavenBot* const mover, float radius)
+void World::getObstacles(std::vector<SGE::Object*>& res, RavenBot* const mover, float radius)
 {
-	return this->getObstacles(mover->getPosition(), radius);
+	this->getObstacles(res, mover->getPosition(), radius);
 }
 
-std::vector<SGE::Object*> World::getObstacles(RavenBot* const mover)
+void World::getObstacles(std::vector<SGE::Object*>& res, RavenBot* const mover)
 {
-	return this->getObstacles(mover->getPosition(), 10.f);
+	this->getObstacles(res, mover->getPosition(), 10.f);
 }
 
-std::vector<SGE::Object*> World::getObstacles(b2Vec2 position, float radius)
+void World::getObstacles(std::vector<SGE::Object*>& res, b2Vec2 position, float radius)
 {
-	auto obs = std::move(this->obstacles.CalculateNeighbours(position, radius));
-	auto rc = std::move(this->rockets.CalculateNeighbours(position, radius));
-	std::vector<SGE::Object*> res(obs.begin(), obs.end());
-	res.insert(res.end(), rc.begin(), rc.end());
-	return res;
+	this->obstacles.CalculateNeighbours(res, position, radius);
+	this->rockets.AppendNeighbours(res, position, radius);
 }
 
-std::vector<Item*> World::getItems(RavenBot* const mover)
+void World::getItems(std::vector<Item*>& res, RavenBot* const mover)
 {
-	auto its = std::move(this->items.CalculateNeighbours(mover->getPosition(), mover->getShape()->getRadius()));
-	return {its.begin(), its.end()};
+	this->items.CalculateNeighbours(res, mover->getPosition(), mover->getShape()->getRadius());
 }
 
-std::vector<Rocket*> World::getRockets(const b2Vec2& position, float radius)
+void World::getRockets(std::vector<Rocket*>& res, const b2Vec2& position, float radius)
 {
-	auto rc = std::move(this->rockets.CalculateNeighbours(position, radius));
-	return {rc.begin(), rc.end()};
+	this->rockets.CalculateNeighbours(res, position, radius);
 }
 
 void World::getNeighbours(std::vector<RavenBot*>& res, RavenBot* const mover)
@@ -47,14 +62,32 @@ void World::getNeighbours(std::vector<RavenBot*>& res, RavenBot* const mover)
 
 void World::getNeighbours(std::vector<RavenBot*>& res, RavenBot* const mover, float radius)
 {
+	if(this->neighbourList.Gather(res, mover, radius)) return;
 	this->getNeighbours(res, mover->getPosition(), radius);
 	res.erase(std::remove(res.begin(), res.end(), mover), res.end());
 }
 
 void World::getNeighbours(std::vector<RavenBot*>& res, b2Vec2 position, float radius)
 {
-	auto nb = std::move(this->movers.CalculateNeighbours(position, radius));
-	res.assign(nb.begin(), nb.end());
+	res.clear();
+	this->forEachNeighbour(position, radius, [&res](RavenBot* mover)
+	{
+		res.push_back(mover);
+	});
+}
+
+void World::UpdateNeighbourList(std::vector<RavenBot>& bots)
+{
+	if(this->neighbourList.Valid(bots)) return;
+	this->neighbourList.Build(bots, [this](b2Vec2 position, float radius, auto visit)
+	{
+		this->forEachNeighbour(position, radius, visit);
+	});
+}
+
+const NeighbourList& World::getNeighbourList() const
+{
+	return this->neighbourList;
 }
 
 std::vector<std::pair<SGE::Object*, Edge>>& World::getWalls()
@@ -62,9 +95,29 @@ std::vector<std::pair<SGE::Object*, Edge>>& World::getWalls()
 	return this->walls;
 }
 
+const EdgeTree& World::getStaticEdges() const
+{
+	if(this->staticDirty)
+	{
+		this->staticEdges.Build();
+		this->staticDirty = false;
+	}
+	return this->staticEdges;
+}
+
 void World::AddObstacle(SGE::Object* ob)
 {
 	this->obstacles.AddEntity(ob);
+	if(ob->getShape()->getType() != SGE::ShapeType::Quad)
+	{
+		++this->roundObstacles;
+		return;
+	}
+	for(const Edge& edge : reinterpret_cast<QuadObstacle*>(ob)->getEdges())
+	{
+		this->staticEdges.Add(ob, Wall(edge.From(), edge.To(), Wall::Invalid));
+	}
+	this->staticDirty = true;
 }
 
 void World::AddItem(Item* i)
@@ -80,6 +133,13 @@ void World::AddRocket(Rocket* r)
 void World::RemoveObstacle(SGE::Object* ob)
 {
 	this->obstacles.RemoveEntity(ob);
+	if(ob->getShape()->getType() != SGE::ShapeType::Quad)
+	{
+		--this->roundObstacles;
+		return;
+	}
+	this->staticEdges.Remove(ob);
+	this->staticDirty = true;
 }
 
 void World::RemoveItem(Item* i)
@@ -94,7 +154,10 @@ void World::RemoveRocket(Rocket* r)
 
 void World::AddMover(RavenBot* mo)
 {
+	mo->partitionPosition = mo->getPosition();
+	mo->partitionMoved = false;
 	this->movers.AddEntity(mo);
+	this->neighbourList.Invalidate();
 }
 
 void World::UpdateObstacle(SGE::Object* obstacle, b2Vec2 oldPos)
@@ -109,12 +172,38 @@ void World::UpdateRocket(Rocket* rocket, b2Vec2 oldPos)
 
 void World::RemoveMover(RavenBot* mo)
 {
+	if(mo->partitionMoved)
+	{
+		this->movers.UpdateEntity(mo, mo->partitionPosition);
+		this->movedMovers.erase(std::find(this->movedMovers.begin(), this->movedMovers.end(), mo));
+		mo->partitionPosition = mo->getPosition();
+		mo->partitionMoved = false;
+	}
 	this->movers.RemoveEntity(mo);
+	this->neighbourList.Invalidate();
 }
 
-void World::UpdateMover(RavenBot* mo, b2Vec2 oldPos)
+void World::UpdateMover(RavenBot* mo)
 {
-	this->movers.UpdateEntity(mo, oldPos);
+	if(!mo->partitionMoved)
+	{
+		mo->partitionMoved = true;
+		this->movedMovers.push_back(mo);
+	}
+	this->moverDrift = std::max(this->moverDrift, b2Distance(mo->getPosition(), mo->partitionPosition));
+	this->neighbourList.Moved(mo);
+}
+
+void World::SyncMovers()
+{
+	for(RavenBot* mo : this->movedMovers)
+	{
+		this->movers.UpdateEntity(mo, mo->partitionPosition);
+		mo->partitionPosition = mo->getPosition();
+		mo->partitionMoved = false;
+	}
+	this->movedMovers.clear();
+	this->moverDrift = 0.f;
 }
 
 void World::AddWall(SGE::Object* wall, Wall::WallEdge edge)
@@ -144,105 +233,120 @@ void World::AddWall(SGE::Object* wall, Wall::WallEdge edge)
 	default:;
 	}
 	this->walls.emplace_back(wall, Wall(from, to, edge));
+	this->staticEdges.Add(wall, Wall(from, to, edge));
+	this->staticDirty = true;
 }
 
 void World::clear()
 {
 	this->movers.ClearCells();
+	for(RavenBot* mo : this->movedMovers)
+	{
+		mo->partitionMoved = false;
+	}
+	this->movedMovers.clear();
+	this->moverDrift = 0.f;
 	this->obstacles.ClearCells();
 	this->walls.clear();
+	this->staticEdges.Clear();
+	this->staticDirty = false;
+	this->roundObstacles = 0u;
+	this->neighbourList.Invalidate();
 }
 
-RavenBot* World::RaycastBot(RavenBot* caster, b2Vec2 from, b2Vec2 direction, b2Vec2& hit) const
+bool World::RayBounds(CellCoord& low, CellCoord& high) const
 {
-	for(size_t index : Ray(from, direction, this->width, this->height, this->cellWidth, this->cellHeight))
-	{
-		b2Vec2 moverHit, obstacleHit;
-		RavenBot* hitMover = this->getHit(from, direction, moverHit, this->movers.getEntities(index), caster);
-		SGE::Object* hitObstacle = this->getHit(from, direction, obstacleHit, this->obstacles.getEntities(index));
-		if(hitMover && hitObstacle)
-		{
-			if(b2DistanceSquared(from, moverHit) < b2DistanceSquared(from, obstacleHit))
-			{
-				hit = moverHit;
-				return hitMover;
-			}
-			else
-			{
-				hit = obstacleHit;
-				return nullptr;
-			}
-		}
-		else if(hitMover)
-		{
-			hit = moverHit;
-			return hitMover;
-		}
-		else if(hitObstacle)
-		{
-			hit = obstacleHit;
-			return nullptr;
-		}
-	}
-	float minDistance = std::numeric_limits<float>::max();
-	float distance = minDistance;
-	b2Vec2 tempHit;
-	for(auto wall : this->walls)
+	if(this->movers.Storage() == PartitionStorage::Dense)
+		return this->movers.Bounds(low, high);
+	bool any = false;
+	auto expand = [&low, &high, &any](CellCoord l, CellCoord h)
 	{
-		LineIntersection(from, from + 1000.f * direction, wall.second.From(), wall.second.To(), distance, tempHit);
-		if(distance < minDistance)
-		{
-			hit = tempHit;
-			minDistance = distance;
-		}
-	}
-	return nullptr;
+		low = any ? CellCoord{std::min(low.x, l.x), std::min(low.y, l.y)} : l;
+		high = any ? CellCoord{std::max(high.x, h.x), std::max(high.y, h.y)} : h;
+		any = true;
+	};
+	CellCoord l, h;
+	//Movers overlap cells next to the ones holding their centres, and may have moved since they were put there
+	const int pad = 1 + int(this->moverDrift / std::min(this->cellWidth, this->cellHeight));
+	if(this->movers.Bounds(l, h)) expand(CellCoord{l.x - pad, l.y - pad}, CellCoord{h.x + pad, h.y + pad});
+	if(this->obstacles.Bounds(l, h)) expand(l, h);
+	if(this->items.Bounds(l, h)) expand(l, h);
+	return any;
 }
 
-Item* World::RaycastItem(b2Vec2 from, b2Vec2 direction, b2Vec2& hit) const
+template<typename T, typename Gather>
+RayHit<T> World::Trace(b2Vec2 from, b2Vec2 direction, float maxDistance, const T* ignore, Gather gather) const
 {
-	for(size_t index : Ray(from, direction, this->width, this->height, this->cellWidth, this->cellHeight))
+	RayHit<T> res;
+	if(direction.Normalize() == 0.f) return res;
+	//Quad obstacles and walls come from the static tree, cells are walked for everything else up to its hit
+	float distance;
+	b2Vec2 point;
+	const EdgeTree::Entry* entry;
+	if(this->getStaticEdges().Raycast(from, from + maxDistance * direction, distance, point, entry))
 	{
-		b2Vec2 moverHit, obstacleHit;
-		Item* hitMover = this->getHit(from, direction, moverHit, this->items.getEntities(index));
-		SGE::Object* hitObstacle = this->getHit(from, direction, obstacleHit, this->obstacles.getEntities(index));
-		if(hitMover && hitObstacle)
-		{
-			if(b2DistanceSquared(from, moverHit) < b2DistanceSquared(from, obstacleHit))
-			{
-				hit = moverHit;
-				return hitMover;
-			}
-			else
-			{
-				hit = obstacleHit;
-				return nullptr;
-			}
-		}
-		else if(hitMover)
+		res.distance = distance;
+		res.point = point;
+		res.normal = entry->edge.Normal();
+		if(b2Dot(res.normal, direction) > 0.f) res.normal = -res.normal;
+	}
+	CellCoord low, high;
+	if(!this->RayBounds(low, high)) return res;
+	auto circle = [&from, &direction, &res](SGE::Object* ob, float limit)
+	{
+		float d;
+		if(!RayCircle(from, direction, ob->getPosition(), ob->getShape()->getRadius(), d) || d >= res.distance || d > limit)
+			return false;
+		res.distance = d;
+		res.point = from + d * direction;
+		res.normal = res.point - ob->getPosition();
+		res.normal.Normalize();
+		return true;
+	};
+	const Ray ray(from, direction, this->width, this->height, this->cellWidth, this->cellHeight, low, high);
+	for(auto it = ray.begin(); it != ray.end(); ++it)
+	{
+		const CellCoord index = *it;
+		//Entity crossing this cell may be hit farther, that hit counts once the walk reaches it
+		const float exit = std::min(it.Exit(), maxDistance);
+		for(T* entity : gather(index))
 		{
-			hit = moverHit;
-			return hitMover;
+			if(entity != ignore && circle(entity, exit))
+				res.entity = entity;
 		}
-		else if(hitObstacle)
+		for(SGE::Object* ob : this->obstacles.getEntities(index))
 		{
-			hit = obstacleHit;
-			return nullptr;
+			if(this->roundObstacles && ob->getShape()->getType() != SGE::ShapeType::Quad && circle(ob, exit))
+				res.entity = nullptr;
 		}
+		//Nothing in cells farther along can be closer
+		if(res.distance <= exit || exit >= maxDistance) break;
 	}
-	float minDistance = std::numeric_limits<float>::max();
-	float distance = minDistance;
-	b2Vec2 tempHit;
-	for(auto wall : this->walls)
+	return res;
+}
+
+RayHit<RavenBot> World::RaycastBot(const RavenBot* caster, b2Vec2 from, b2Vec2 direction, float maxDistance) const
+{
+	return this->RaycastBot(caster, from, direction, this->rayMovers, maxDistance);
+}
+
+RayHit<RavenBot> World::RaycastBot(const RavenBot* caster, b2Vec2 from, b2Vec2 direction, std::vector<RavenBot*>& buffer,
+								   float maxDistance) const
+{
+	//Movers are stored by centre, so bot crossing a cell may be in a neighbouring one
+	return this->Trace(from, direction, maxDistance, caster, [this, &buffer](CellCoord index) -> const std::vector<RavenBot*>&
 	{
-		LineIntersection(from, from + 1000.f * direction, wall.second.From(), wall.second.To(), distance, tempHit);
-		if(distance < minDistance)
-		{
-			hit = tempHit;
-			minDistance = distance;
-		}
-	}
-	return nullptr;
+		this->movers.GatherEntities(buffer, index, this->moverDrift);
+		return buffer;
+	});
+}
+
+RayHit<Item> World::RaycastItem(b2Vec2 from, b2Vec2 direction, float maxDistance) const
+{
+	return this->Trace(from, direction, maxDistance, static_cast<const Item*>(nullptr), [this](CellCoord index) -> const std::vector<Item*>&
+	{
+		return this->items.getEntities(index);
+	});
 }
 
 World::Ray::RayIterator World::Ray::begin() const
@@ -256,7 +360,7 @@ World::Ray::RayIterator World::Ray::begin() const
 	tMaxY = ((Y + std::max(0, deltaY)) * this->cellHeight - this->from.y) / this->direction.y;
 	tDeltaX = std::abs(this->cellWidth / this->direction.x);
 	tDeltaY = std::abs(this->cellHeight / this->direction.y);
-	return RayIterator(tMaxX, tMaxY, tDeltaX, tDeltaY, deltaX, deltaY, X, Y);
+	return RayIterator(tMaxX, tMaxY, tDeltaX, tDeltaY, deltaX, deltaY, X, Y, this->low, this->high);
 }
 
 World::Ray::RayIterator World::Ray::end() const
@@ -265,13 +369,13 @@ World::Ray::RayIterator World::Ray::end() const
 }
 
 constexpr World::Ray::RayIterator::RayIterator(float max_x, float max_y, float delta_x, float delta_y,
-											   int delta_x1, int delta_y1, int x, int y)
+											   int delta_x1, int delta_y1, int x, int y, CellCoord low, CellCoord high)
 	:tDeltaX(delta_x), tDeltaY(delta_y), deltaX(delta_x1), deltaY(delta_y1),
-	tMaxX(max_x), tMaxY(max_y), X(x), Y(y)
+	tMaxX(max_x), tMaxY(max_y), X(x), Y(y), low(low), high(high)
 {}
 
-World::Ray::Ray(b2Vec2 from, b2Vec2 direction, float width, float height, float cellWidth, float cellHeight)
-	: from(from), direction(direction), width(width), height(height), cellWidth(cellWidth), cellHeight(cellHeight)
+World::Ray::Ray(b2Vec2 from, b2Vec2 direction, float width, float height, float cellWidth, float cellHeight, CellCoord low, CellCoord high)
+	: from(from), direction(direction), width(width), height(height), cellWidth(cellWidth), cellHeight(cellHeight), low(low), high(high)
 {}
 
 World::Ray::RayIterator& World::Ray::RayIterator::operator++()
@@ -289,10 +393,15 @@ World::Ray::RayIterator& World::Ray::RayIterator::operator++()
 	return *this;
 }
 
-size_t World::Ray::RayIterator::operator*() const
+float World::Ray::RayIterator::Exit() const
+{
+	return std::min(this->tMaxX, this->tMaxY);
+}
+
+CellCoord World::Ray::RayIterator::operator*() const
 {
 	//std::cout << "X: " << this->X << " Y: " << this->Y << std::endl;
-	return size_t(this->X + partitionX * Y);
+	return CellCoord{this->X, this->Y};
 }
 
 bool World::Ray::RayIterator::operator==(const RayIterator& other) const
@@ -302,5 +411,5 @@ bool World::Ray::RayIterator::operator==(const RayIterator& other) const
 
 bool World::Ray::RayIterator::operator!=(const RayIterator& other) const
 {
-	return (X >= 0 && X < partitionX) && (Y >= 0 && Y < partitionY);
+	return (X >= this->low.x && X <= this->high.x) && (Y >= this->low.y && Y <= this->high.y);
 }
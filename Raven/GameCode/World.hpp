@@ -1,5 +1,8 @@
 #pragma once
+#include <limits>
 #include "CellSpacePartition.hpp"
+#include "EdgeTree.hpp"
+#include "NeighbourList.hpp"
 #include "RavenBot.hpp"
 #include "Wall.hpp"
 #include "Utilities.hpp"
@@ -7,57 +10,184 @@
 
 namespace
 {
-	constexpr size_t partitionX = 8u;
-	constexpr size_t partitionY = 8u;
+	//Partition cells are sized for neighbour queries of this radius (see PartitionGrid::Tuned)
+	constexpr float partitionQueryRadius = 5.f;
+	constexpr float partitionEntityRadius = 1.f;
+	//Bot neighbour queries up to this radius are answered from the neighbour list
+	constexpr float neighbourListRadius = 10.f;
+	constexpr float neighbourListSkin = 1.f;
+	//Rays end this far away unless they are given shorter distance
+	constexpr float rayDistance = 1000.f;
 }
 
+//Closest hit of a ray. Entity is null when the ray ends at an obstacle or a wall, distance is infinite when it hits nothing
+template<typename T>
+struct RayHit
+{
+	T* entity = nullptr;
+	b2Vec2 point = b2Vec2_zero;
+	float distance = std::numeric_limits<float>::infinity();
+	//Unit normal of the surface facing the ray
+	b2Vec2 normal = b2Vec2_zero;
+
+	explicit operator bool() const
+	{
+		return this->distance < std::numeric_limits<float>::infinity();
+	}
+};
+
 class World
 {
 protected:
-	CellSpacePartition<RavenBot, partitionX, partitionY> movers;
-	CellSpacePartition<SGE::Object, partitionX, partitionY> obstacles;
-	CellSpacePartition<Rocket, partitionX, partitionY> rockets;
-	CellSpacePartition<Item, partitionX, partitionY> items;
+	//All partitions share one grid, so ray cell coordinates are valid in each of them
+	const PartitionGrid grid;
+	CellSpacePartition<RavenBot> movers;
+	CellSpacePartition<SGE::Object> obstacles;
+	CellSpacePartition<Rocket> rockets;
+	CellSpacePartition<Item> items;
 	std::vector<std::pair<SGE::Object*, Edge>> walls;
+	//Quad obstacle edges and walls, rebuilt by the first query after they change
+	mutable EdgeTree staticEdges;
+	mutable bool staticDirty = false;
+	//Obstacles which are not quads, rays still look for them in cells
+	size_t roundObstacles = 0u;
+	NeighbourList neighbourList;
+	//Movers moved since the last SyncMovers
+	std::vector<RavenBot*> movedMovers;
+	//Upper bound of distance between any mover and its position in the partition
+	float moverDrift = 0.f;
 	const float width, height, cellWidth, cellHeight;
+	//Raycast buffer reused between calls
+	mutable std::vector<RavenBot*> rayMovers;
+
+	//Cells ray may need to visit, false when all partitions are empty
+	bool RayBounds(CellCoord& low, CellCoord& high) const;
+	//Closest of static edges, round obstacles and entities other than ignore which gather(cell) returns for cells
+	//along the ray. Cells are walked in order and the walk ends at the first one holding a hit
+	template<typename T, typename Gather>
+	RayHit<T> Trace(b2Vec2 from, b2Vec2 direction, float maxDistance, const T* ignore, Gather gather) const;
+	//Records that mover has moved, called by RavenBot::setPosition
+	void UpdateMover(RavenBot* mo);
+	friend class RavenBot;
 public:
 	class Ray
 	{
 	protected:
 		b2Vec2 from, direction;
 		float width, height, cellWidth, cellHeight;
+		CellCoord low, high;
 	public:
-		Ray(b2Vec2 from, b2Vec2 direction, float width, float height, float cellWidth, float cellHeight);
+		//Visits cells between low and high, inclusive
+		Ray(b2Vec2 from, b2Vec2 direction, float width, float height, float cellWidth, float cellHeight, CellCoord low, CellCoord high);
 		class RayIterator
 		{
 			const float tDeltaX = 0.f , tDeltaY = 0.f;
 			const int deltaX = 0u, deltaY = 0u;
 			float tMaxX = 0.f, tMaxY = 0.f;
 			int X = 0u, Y = 0u;
+			const CellCoord low, high;
 		public:
 			constexpr RayIterator() = default;
 			constexpr RayIterator(float max_x, float max_y, float delta_x, float delta_y,
-								  int delta_x1, int delta_y1, int x, int y);
+								  int delta_x1, int delta_y1, int x, int y, CellCoord low, CellCoord high);
 
 			RayIterator& operator++();
-			size_t operator*() const;
+			CellCoord operator*() const;
+			//Ray parameter where ray leaves current cell
+			float Exit() const;
 			bool operator==(const RayIterator& other) const;
 			bool operator!=(const RayIterator& other) const;
 		};
 		RayIterator begin() const;
 		RayIterator end() const;
 	};
-	World(float width, float height);
+	//Hashed storage lets entities leave width x height area, dense one clamps them to its border cells
+	World(float width, float height, float queryRadius = partitionQueryRadius, float entityRadius = partitionEntityRadius,
+		  PartitionStorage storage = PartitionStorage::Dense);
 
-	std::vector<SGE::Object*> getObstacles(RavenBot* const mover, float radius);
-	std::vector<SGE::Object*> getObstacles(RavenBot* const mover);
-	std::vector<SGE::Object*> getObstacles(b2Vec2 position, float radius);
+	//Queries fill caller's buffer, which is cleared first, and do not allocate once it is large enough.
+	//Obstacles include rockets
+	void getObstacles(std::vector<SGE::Object*>& res, RavenBot* const mover, float radius);
+	void getObstacles(std::vector<SGE::Object*>& res, RavenBot* const mover);
+	void getObstacles(std::vector<SGE::Object*>& res, b2Vec2 position, float radius);
 
 	void getNeighbours(std::vector<RavenBot*>& res, RavenBot* const mover);
 	void getNeighbours(std::vector<RavenBot*>& res, RavenBot* const mover, float radius);
 	void getNeighbours(std::vector<RavenBot*>& res, b2Vec2 position, float radius);
+	//Rebuilds neighbour list when some bot left its skin, queries around bots use it until then
+	void UpdateNeighbourList(std::vector<RavenBot>& bots);
+	const NeighbourList& getNeighbourList() const;
+
+	void getItems(std::vector<Item*>& res, RavenBot* const mover);
+	void getRockets(std::vector<Rocket*>& res, const b2Vec2& position, float radius);
+
+	//Visitor versions of the queries above, visit is called once per entity
+	template<typename F>
+	void forEachObstacle(b2Vec2 position, float radius, F visit)
+	{
+		this->obstacles.ForEachNeighbour(position, radius, visit);
+		this->rockets.ForEachNeighbour(position, radius, visit);
+	}
+
+	template<typename F>
+	void forEachNeighbour(b2Vec2 position, float radius, F visit)
+	{
+		if(this->moverDrift == 0.f)
+		{
+			this->movers.ForEachNeighbour(position, radius, visit);
+			return;
+		}
+		//Partition still holds movers where they were before SyncMovers, so it is searched farther
+		//and its results are filtered by current positions
+		this->movers.ForEachNeighbour(position, radius + this->moverDrift, [position, radius, &visit](RavenBot* mover)
+		{
+			const float reach = radius + mover->getShape()->getRadius();
+			if(b2DistanceSquared(position, mover->getPosition()) < reach * reach)
+				visit(mover);
+		});
+	}
+
+	template<typename F>
+	void forEachRocket(b2Vec2 position, float radius, F visit)
+	{
+		this->rockets.ForEachNeighbour(position, radius, visit);
+	}
+
+	//Closest movers and items accepted by match, found by ring search over partition cells
+	//(see CellSpacePartition::Nearest). The k versions replace res, closest first
+	template<typename F>
+	RavenBot* nearestMover(b2Vec2 position, F match) const
+	{
+		return this->movers.Nearest(position, match, this->moverDrift);
+	}
+
+	template<typename F>
+	void nearestMovers(std::vector<RavenBot*>& res, b2Vec2 position, size_t k, F match) const
+	{
+		this->movers.KNearest(res, position, k, match, this->moverDrift);
+	}
+
+	template<typename F>
+	Item* nearestItem(b2Vec2 position, F match) const
+	{
+		return this->items.Nearest(position, match);
+	}
+
+	template<typename F>
+	void nearestItems(std::vector<Item*>& res, b2Vec2 position, size_t k, F match) const
+	{
+		this->items.KNearest(res, position, k, match);
+	}
 
 	std::vector<std::pair<SGE::Object*, Edge>>& getWalls();
+	const EdgeTree& getStaticEdges() const;
+
+	//Calls visit with every quad obstacle edge and wall which may be within radius of position
+	template<typename F>
+	void forEachStaticEdge(b2Vec2 position, float radius, F visit) const
+	{
+		this->getStaticEdges().ForEachNear(position, radius, visit);
+	}
 
 	void AddMover(RavenBot* mo);
 	void AddObstacle(SGE::Object* ob);
@@ -70,67 +200,20 @@ public:
 
 	void UpdateObstacle(SGE::Object* rocket, b2Vec2 oldPos);
 	void UpdateRocket(Rocket* rocket, b2Vec2 oldPos);
-	void UpdateMover(RavenBot* mo, b2Vec2 oldPos);
+	//Partition is updated for all movers moved since the last call at once. Queries account for movers which have
+	//not been synced yet
+	void SyncMovers();
 
 	void AddWall(SGE::Object* wall, Wall::WallEdge edge);
 
 	void clear();
 
-	template<typename T>
-	T* getHit(b2Vec2 from, b2Vec2 direction, b2Vec2& hit, const std::vector<T*>& entities, T* ignore = nullptr) const
-	{
-		T* closestObject = nullptr;
-		float closestDist = std::numeric_limits<float>::max();
-		for(T* ob : entities)
-		{
-			if(ob == ignore) continue;
-			if(ob->getShape()->getType() != SGE::ShapeType::Quad)
-			{
-				b2Vec2 localPos = PointToLocalSpace(ob->getPosition(), direction, from);
-				float obRadius = ob->getShape()->getRadius();
-				if(localPos.x >= 0.f)
-				{
-					if(b2Abs(localPos.y) < obRadius)
-					{
-						float cX = localPos.x, cY = localPos.y;
-						float sqrtPart = sqrt(obRadius*obRadius - cY*cY);
-						float ip = cX - sqrtPart;
-						if(ip <= 0.f) ip = cX + sqrtPart;
-						if(ip < closestDist)
-						{
-							closestDist = ip;
-							closestObject = ob;
-							hit = PointToWorldSpace(b2Vec2{ip,0.f}, direction, from);
-						}
-					}
-				}
-			}
-			else
-			{
-				QuadObstacle* qob = reinterpret_cast<QuadObstacle*>(ob);
-				if(!qob) continue;
-				float ip;
-				b2Vec2 point;
-				for(auto& wall : qob->getEdges())
-				{
-					if(LineIntersection(from, from + 100.f * direction, wall.From(), wall.To(), ip, point))
-					{
-						if(ip < closestDist)
-						{
-							closestDist = ip;
-							closestObject = ob;
-							hit = point;
-						}
-					}
-				}
-			}
-		}
-		return closestObject;
-	}
-
-	RavenBot* RaycastBot(RavenBot* caster, b2Vec2 from, b2Vec2 direction, b2Vec2& hit) const;
-	Item* RaycastItem(b2Vec2 from, b2Vec2 direction, b2Vec2& hit) const;
+	//Closest of bots other than caster, obstacles and walls along direction, up to maxDistance from the origin
+	RayHit<RavenBot> RaycastBot(const RavenBot* caster, b2Vec2 from, b2Vec2 direction, float maxDistance = rayDistance) const;
+	//Gathers movers into caller's buffer, so rays may be cast from several threads while the world does not change.
+	//getStaticEdges has to be called before that
+	RayHit<RavenBot> RaycastBot(const RavenBot* caster, b2Vec2 from, b2Vec2 direction, std::vector<RavenBot*>& buffer,
+								float maxDistance = rayDistance) const;
+	RayHit<Item> RaycastItem(b2Vec2 from, b2Vec2 direction, float maxDistance = rayDistance) const;
 	void RemoveMover(RavenBot* hitObject);
-	std::vector<Item*> getItems(RavenBot* const mover);
-	std::vector<Rocket*> getRockets(const b2Vec2& position, float radius);
 };
@@ -7,6 +7,7 @@
 //
 
 #include <iostream>
+#include <cstdlib>
 #include <boost/filesystem.hpp>
 
 #include <Game/sge_game.hpp>
@@ -18,11 +19,10 @@
 
 namespace fs = boost::filesystem;
 
+//Usage: Raven [level seed]
+//Without a seed every load generates a new level
 int main(int argc, char * argv[])
 {
-    (void)argc;
-    (void)argv;
-
     std::cout.setf(std::ios::boolalpha);
     std::cout.sync_with_stdio(true);
 
@@ -41,6 +41,8 @@ int main(int argc, char * argv[])
 	SGE::Scene* S2 = new EndScene(S1, "Resources/Textures/end-game.png", "Resources/Textures/lost-game.png");
 
 	S1->endScene = S2;
+	if(argc > 1)
+		S1->FixSeed(unsigned(std::strtoul(argv[1], nullptr, 10)));
 
 	director->addScene(S0);
 	director->addScene(S1);
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "GameCode/Headless.hpp"
+#include "GameCode/RavenScene.hpp"
+
+//Times navgraph A* with open list Q on the same random queries
+template<template<typename> class Q>
+void BenchmarkAStar(const GridCSR& navgraph, const std::vector<std::pair<GridCSR::Index, GridCSR::Index>>& queries, const char* name)
+{
+	CTL::SearchContext<GridCSR::Index, Q> context;
+	std::vector<GridCSR::Index> path;
+	size_t expanded = 0u, length = 0u, found = 0u;
+	using Clock = std::chrono::steady_clock;
+	const auto start = Clock::now();
+	for(const auto& query : queries)
+	{
+		if(navgraph.AStar(query.first, query.second, DiagonalDistance(), context, path))
+		{
+			++found;
+			length += path.size();
+		}
+		expanded += context.Expanded();
+	}
+	const std::chrono::duration<double> elapsed = Clock::now() - start;
+	std::cout << name << ": " << 1e6 * elapsed.count() / queries.size() << " us/query, "
+		<< double(expanded) / queries.size() << " expanded/query, "
+		<< found << " found, " << length << " path vertices" << std::endl;
+}
+
+//Usage: RavenHeadless astar [queries] [seed]
+int AStarMain(int argc, char * argv[])
+{
+	const size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000u;
+	const unsigned seed = argc > 3 ? unsigned(std::strtoul(argv[3], nullptr, 10)) : 0u;
+	HeadlessRaven raven(0u, SimulationClock(), seed);
+	const GridCSR& navgraph = raven.GameState()->navgraph;
+	if(count == 0u || navgraph.Empty())
+	{
+		std::cerr << "Usage: " << argv[0] << " astar [queries] [seed]" << std::endl;
+		return 1;
+	}
+	std::mt19937 engine(seed);
+	std::uniform_int_distribution<GridCSR::Index> vertex(0u, GridCSR::Index(navgraph.VertexCount() - 1u));
+	std::vector<std::pair<GridCSR::Index, GridCSR::Index>> queries(count);
+	for(auto& query : queries)
+	{
+		query = {vertex(engine), vertex(engine)};
+	}
+	std::cout << "Navgraph: " << navgraph.VertexCount() << " vertices, " << navgraph.EdgeCount() << " edges" << std::endl;
+	BenchmarkAStar<CTL::LazyQueue>(navgraph, queries, "std heap, lazy deletion");
+	BenchmarkAStar<CTL::QuadHeap>(navgraph, queries, "indexed 4-ary heap");
+
+	const JumpPointSearch& jps = raven.GameState()->jps;
+	GridSearch context;
+	std::vector<JumpPointSearch::Index> path;
+	size_t expanded = 0u, length = 0u, found = 0u;
+	using Clock = std::chrono::steady_clock;
+	const auto start = Clock::now();
+	for(const auto& query : queries)
+	{
+		if(jps.Search(jps.CellIndex(navgraph.Label(query.first).position), jps.CellIndex(navgraph.Label(query.second).position), context, path))
+		{
+			++found;
+			length += path.size();
+		}
+		expanded += context.Expanded();
+	}
+	const std::chrono::duration<double> elapsed = Clock::now() - start;
+	std::cout << "jump point search: " << 1e6 * elapsed.count() / queries.size() << " us/query, "
+		<< double(expanded) / queries.size() << " expanded/query, "
+		<< found << " found, " << length << " path vertices" << std::endl;
+
+	//Hierarchical paths are walked to the end, so lazy refinement is timed as well
+	HierarchicalPlanner& hpa = raven.GameState()->hpa;
+	length = 0u;
+	found = 0u;
+	const auto hpaStart = Clock::now();
+	for(const auto& query : queries)
+	{
+		Path hierarchical = hpa.FindPath(query.first, query.second, context);
+		if(hierarchical.Empty()) continue;
+		++found;
+		for(++length; !hierarchical.Finished(); ++length)
+		{
+			hierarchical.SetNextWaypoint();
+		}
+	}
+	const std::chrono::duration<double> hpaElapsed = Clock::now() - hpaStart;
+	std::cout << "hierarchical (" << hpa.EntranceCount() << " entrances): " << 1e6 * hpaElapsed.count() / queries.size() << " us/query, "
+		<< found << " found, " << length << " path vertices" << std::endl;
+	return 0;
+}
+
+//Usage: RavenHeadless [matches] [ticks per match] [tick in seconds] [ticks per decision] [seed] [path threads] [simulation threads]
+//	[dense|hashed partition storage]
+//Matches are reproducible only without path threads
+int main(int argc, char * argv[])
+{
+	if(argc > 1 && std::strcmp(argv[1], "astar") == 0)
+		return AStarMain(argc, argv);
+
+	const size_t matches = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1u;
+	const size_t ticks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 120u * 60u * 5u;
+	const float tick = argc > 3 ? std::strtof(argv[3], nullptr) : 1.f / 120.f;
+	const unsigned decisionRate = argc > 4 ? unsigned(std::strtoul(argv[4], nullptr, 10)) : 4u;
+	const unsigned seed = argc > 5 ? unsigned(std::strtoul(argv[5], nullptr, 10)) : 0u;
+	const unsigned pathThreads = argc > 6 ? unsigned(std::strtoul(argv[6], nullptr, 10)) : 0u;
+	const unsigned simulationThreads = argc > 7 ? unsigned(std::strtoul(argv[7], nullptr, 10)) : 0u;
+	const char* storageName = argc > 8 ? argv[8] : "dense";
+	const bool hashed = std::strcmp(storageName, "hashed") == 0;
+
+	if(matches == 0u || ticks == 0u || !(tick > 0.f) || decisionRate == 0u || (!hashed && std::strcmp(storageName, "dense") != 0))
+	{
+		std::cerr << "Usage: " << argv[0] << " [matches] [ticks per match] [tick in seconds] [ticks per decision] [seed] [path threads] [simulation threads] [dense|hashed]" << std::endl;
+		return 1;
+	}
+
+	using Clock = std::chrono::steady_clock;
+	const auto start = Clock::now();
+	size_t cacheHits = 0u, cacheSuffixHits = 0u, cacheMisses = 0u, neighbourBuilds = 0u;
+	for(size_t match = 0u; match < matches; ++match)
+	{
+		HeadlessRaven raven(Bots, SimulationClock(tick, decisionRate), seed + unsigned(match), pathThreads, simulationThreads,
+			hashed ? PartitionStorage::Hashed : PartitionStorage::Dense);
+		raven.Run(ticks);
+		const PathCache& cache = raven.GameState()->pathCache;
+		cacheHits += cache.Hits();
+		cacheSuffixHits += cache.SuffixHits();
+		cacheMisses += cache.Misses();
+		neighbourBuilds += raven.GameState()->world->getNeighbourList().Builds();
+	}
+	const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+	const double total = double(matches) * double(ticks);
+	std::cout << "Matches: " << matches << '\n'
+		<< "Partition storage: " << storageName << '\n'
+		<< "Ticks per match: " << ticks << " (" << ticks * tick << "s simulated)\n"
+		<< "Wall time: " << elapsed.count() << "s\n"
+		<< "Ticks per second: " << total / elapsed.count() << '\n'
+		<< "Microseconds per tick: " << 1e6 * elapsed.count() / total << '\n'
+		<< "Path cache: " << cacheHits << " hits (" << cacheSuffixHits << " suffix), " << cacheMisses << " misses\n"
+		<< "Neighbour list builds per tick: " << double(neighbourBuilds) / total << std::endl;
+	return 0;
+}